@@ -0,0 +1,138 @@
+// Block compression speed and quality for each format, kernel level (scalar,
+// SSE4.1, AVX2) and thread count, on a generated RGBA image or one loaded
+// from a file. Quality is the PSNR of the decoded image against the source.
+//
+//   block_compress_bench [--size N] [--image FILE] [--iterations M]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include "core/block_compress.h"
+#include "stb_image.h"
+
+// Smooth gradients, hard edges and a soft alpha ramp, so every format has
+// something it is bad at
+static std::vector<unsigned char> createImage(int size) {
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char* p = &pixels[((size_t)y * size + x) * 4];
+            float u = (float)x / size, v = (float)y / size;
+            bool square = ((x / 24 + y / 24) & 1) != 0;
+            p[0] = (unsigned char)(255.0f * u);
+            p[1] = square ? 200 : (unsigned char)(255.0f * v);
+            p[2] = (unsigned char)(127.5f + 127.5f * std::sin(u * 20.0f) * std::cos(v * 13.0f));
+            p[3] = (unsigned char)(255.0f * (0.5f + 0.5f * std::sin((u + v) * 6.0f)));
+        }
+    }
+    return pixels;
+}
+
+// Returns milliseconds per image (median over the iterations)
+static double timeCompress(const std::vector<unsigned char>& pixels, int width, int height, BlockFormat format,
+                           const BlockCompressOptions& options, std::vector<unsigned char>& blocks, int iterations) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        compressImage(pixels.data(), width, height, format, options, blocks);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// BC1 has no alpha, so only colour counts for it
+static double computePsnr(const std::vector<unsigned char>& original, const std::vector<unsigned char>& blocks,
+                          int width, int height, BlockFormat format) {
+    std::vector<unsigned char> decoded;
+    if (!decompressImage(blocks.data(), width, height, format, decoded)) {
+        return 0.0;
+    }
+    int channels = format == BlockFormat::BC1 ? 3 : 4;
+    double squaredError = 0.0;
+    for (size_t i = 0; i < decoded.size(); i++) {
+        if ((int)(i % 4) < channels) {
+            double d = (double)decoded[i] - original[i];
+            squaredError += d * d;
+        }
+    }
+    double meanSquaredError = squaredError / ((double)width * height * channels);
+    return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+}
+
+int main(int argc, char** argv) {
+    int size = 1024;
+    int iterations = 3;
+    std::string imagePath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (arg == "--image" && i + 1 < argc) {
+            imagePath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--size N] [--image FILE] [--iterations M]" << std::endl;
+            return -1;
+        }
+    }
+    if (size < 1 || iterations < 1) {
+        std::cerr << "--size and --iterations must be positive" << std::endl;
+        return -1;
+    }
+
+    int width = size, height = size;
+    std::vector<unsigned char> pixels;
+    if (!imagePath.empty()) {
+        int channels;
+        unsigned char* loaded = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+        if (!loaded) {
+            std::cerr << "Failed to load " << imagePath << ": " << stbi_failure_reason() << std::endl;
+            return -1;
+        }
+        pixels.assign(loaded, loaded + (size_t)width * height * 4);
+        stbi_image_free(loaded);
+    } else {
+        pixels = createImage(size);
+    }
+
+    SimdLevel best = detectSimdLevel();
+    int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    double texels = (double)width * height;
+    std::cout << "Image: " << width << "x" << height << " RGBA (" << pixels.size() / 1024 << " KiB)" << std::endl;
+    std::cout << "Best supported kernel: " << simdLevelName(best) << ", hardware threads: " << hardwareThreads << std::endl;
+
+    for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 }) {
+        BlockCompressOptions options;
+        options.threads = 1;
+        std::cout << blockFormatName(format) << " (" << getCompressedSize(format, width, height) / 1024 << " KiB):" << std::endl;
+
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2 }) {
+            if (level > best) {
+                continue;
+            }
+            options.maxSimd = level;
+            std::vector<unsigned char> blocks;
+            double ms = timeCompress(pixels, width, height, format, options, blocks, iterations);
+            std::cout << "  " << simdLevelName(level) << ", 1 thread: " << ms << " ms, " << texels / ms / 1e3
+                      << " Mtexels/s, PSNR " << computePsnr(pixels, blocks, width, height, format) << " dB" << std::endl;
+        }
+
+        if (hardwareThreads > 1) {
+            options.maxSimd = best;
+            options.threads = 0;
+            std::vector<unsigned char> blocks;
+            double ms = timeCompress(pixels, width, height, format, options, blocks, iterations);
+            std::cout << "  " << simdLevelName(best) << ", " << hardwareThreads << " threads: " << ms << " ms, "
+                      << texels / ms / 1e3 << " Mtexels/s" << std::endl;
+        }
+    }
+    return 0;
+}
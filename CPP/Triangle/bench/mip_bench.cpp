@@ -0,0 +1,146 @@
+// Mip chain build time for each filter, kernel level (scalar, SSE4.1, AVX2)
+// and thread count, on a generated RGBA image or one loaded from a file.
+// Also checks that the SIMD kernels match the scalar ones to within one
+// 8-bit step per channel.
+//
+//   mip_bench [--size N] [--image FILE] [--iterations M] [--linear]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include "core/mip_builder.h"
+#include "stb_image.h"
+
+// Fine stripes over smooth gradients: enough high-frequency detail for the
+// filters to differ, and colours across the whole range
+static std::vector<unsigned char> createImage(int size) {
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char* p = &pixels[((size_t)y * size + x) * 4];
+            float u = (float)x / size, v = (float)y / size;
+            float stripes = 0.5f + 0.5f * std::sin((x + y) * 0.7f + 40.0f * u * v);
+            p[0] = (unsigned char)(255.0f * u);
+            p[1] = (unsigned char)(255.0f * stripes);
+            p[2] = (unsigned char)(255.0f * v);
+            p[3] = (unsigned char)(((x / 16 + y / 16) & 1) ? 255 : 128);
+        }
+    }
+    return pixels;
+}
+
+// Returns milliseconds per chain (median over the iterations)
+static double timeBuild(const std::vector<unsigned char>& pixels, int width, int height, const MipOptions& options,
+                        std::vector<std::vector<unsigned char>>& mips, int iterations) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        buildMipChain(pixels.data(), width, height, 4, options, mips);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static int maxDifference(const std::vector<std::vector<unsigned char>>& a, const std::vector<std::vector<unsigned char>>& b) {
+    int result = 0;
+    for (size_t level = 0; level < a.size(); level++) {
+        for (size_t i = 0; i < a[level].size(); i++) {
+            result = std::max(result, std::abs((int)a[level][i] - (int)b[level][i]));
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int size = 2048;
+    int iterations = 5;
+    bool srgb = true;
+    std::string imagePath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (arg == "--image" && i + 1 < argc) {
+            imagePath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (arg == "--linear") {
+            srgb = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--size N] [--image FILE] [--iterations M] [--linear]" << std::endl;
+            return -1;
+        }
+    }
+    if (size < 1 || iterations < 1) {
+        std::cerr << "--size and --iterations must be positive" << std::endl;
+        return -1;
+    }
+
+    int width = size, height = size;
+    std::vector<unsigned char> pixels;
+    if (!imagePath.empty()) {
+        int channels;
+        unsigned char* loaded = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+        if (!loaded) {
+            std::cerr << "Failed to load " << imagePath << ": " << stbi_failure_reason() << std::endl;
+            return -1;
+        }
+        pixels.assign(loaded, loaded + (size_t)width * height * 4);
+        stbi_image_free(loaded);
+    } else {
+        pixels = createImage(size);
+    }
+
+    SimdLevel best = detectSimdLevel();
+    int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Image: " << width << "x" << height << " RGBA, " << mipLevelCount(width, height) << " levels, "
+              << (srgb ? "sRGB" : "linear") << std::endl;
+    std::cout << "Best supported kernel: " << simdLevelName(best) << ", hardware threads: " << hardwareThreads << std::endl;
+
+    int result = 0;
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+        MipOptions options;
+        options.filter = filter;
+        options.srgb = srgb;
+        options.threads = 1;
+        options.maxSimd = SimdLevel::Scalar;
+
+        std::vector<std::vector<unsigned char>> reference;
+        double scalarMs = timeBuild(pixels, width, height, options, reference, iterations);
+        std::cout << mipFilterName(filter) << ":" << std::endl;
+        std::cout << "  scalar, 1 thread: " << scalarMs << " ms" << std::endl;
+
+        for (SimdLevel level : { SimdLevel::SSE41, SimdLevel::AVX2 }) {
+            if (level > best) {
+                continue;
+            }
+            options.maxSimd = level;
+            std::vector<std::vector<unsigned char>> mips;
+            double ms = timeBuild(pixels, width, height, options, mips, iterations);
+            int difference = maxDifference(reference, mips);
+            std::cout << "  " << simdLevelName(level) << ", 1 thread: " << ms << " ms, " << scalarMs / ms
+                      << "x scalar, max difference " << difference << std::endl;
+            if (difference > 1) {
+                std::cerr << simdLevelName(level) << " kernels differ from the scalar ones by more than one step" << std::endl;
+                result = 1;
+            }
+        }
+
+        if (hardwareThreads > 1) {
+            options.maxSimd = best;
+            options.threads = 0;
+            std::vector<std::vector<unsigned char>> mips;
+            double ms = timeBuild(pixels, width, height, options, mips, iterations);
+            std::cout << "  " << simdLevelName(best) << ", " << hardwareThreads << " threads: " << ms << " ms, "
+                      << scalarMs / ms << "x scalar" << std::endl;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,224 @@
+// Vertex throughput of the Phong vertex shader with the normal matrix computed
+// per vertex (mat3(transpose(inverse(model)))) versus passed in as a uniform.
+//
+// Draws a dense grid into a tiny viewport so the run is bound by vertex
+// processing rather than fill rate, and reports vertices per second for both
+// variants. Each sample times a batch of draws followed by one glFinish, so
+// the finish and the fixed cost per draw do not hide the vertex work.
+//
+//   normal_matrix_bench [--grid N] [--iterations M] [--batch K] [--window]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "core/gl_context.h"
+#include "core/gl_objects.h"
+#include "core/shader_program.h"
+
+// Same structure as phong_triangle.cpp; NORMAL_MATRIX_UNIFORM selects the variant
+const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+#ifdef NORMAL_MATRIX_UNIFORM
+uniform mat3 normalMatrix;
+#endif
+
+void main() {
+    FragPos = vec3(model * vec4(position, 1.0));
+#ifdef NORMAL_MATRIX_UNIFORM
+    Normal = normalMatrix * normal;
+#else
+    Normal = mat3(transpose(inverse(model))) * normal;
+#endif
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
+}
+)";
+
+const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec3 Normal;
+
+void main() {
+    FragColor = vec4(normalize(Normal) * 0.5 + 0.5, 1.0);
+}
+)";
+
+// Indexed grid; core's Mesh only draws non-indexed arrays
+struct GridMesh {
+    GLVertexArray vertexArray;
+    GLBuffer vertexBuffer;
+    GLBuffer indexBuffer;
+    GLsizei indexCount = 0;
+    size_t vertexCount = 0;
+};
+
+// Wavy height field with analytic normals, (grid + 1)^2 vertices
+static bool createGridMesh(int grid, GridMesh& mesh) {
+    std::vector<float> vertices;
+    std::vector<GLuint> indices;
+    vertices.reserve((size_t)(grid + 1) * (grid + 1) * 6);
+    indices.reserve((size_t)grid * grid * 6);
+
+    for (int y = 0; y <= grid; y++) {
+        for (int x = 0; x <= grid; x++) {
+            float u = (float)x / grid * 2.0f - 1.0f;
+            float v = (float)y / grid * 2.0f - 1.0f;
+            float h = 0.05f * std::sin(u * 12.0f) * std::cos(v * 12.0f);
+            float dhdu = 0.6f * std::cos(u * 12.0f) * std::cos(v * 12.0f);
+            float dhdv = -0.6f * std::sin(u * 12.0f) * std::sin(v * 12.0f);
+            glm::vec3 n = glm::normalize(glm::vec3(-dhdu, -dhdv, 1.0f));
+            vertices.insert(vertices.end(), { u, v, h, n.x, n.y, n.z });
+        }
+    }
+    for (int y = 0; y < grid; y++) {
+        for (int x = 0; x < grid; x++) {
+            GLuint i0 = y * (grid + 1) + x;
+            GLuint i1 = i0 + 1;
+            GLuint i2 = i0 + (grid + 1);
+            GLuint i3 = i2 + 1;
+            indices.insert(indices.end(), { i0, i1, i2, i1, i3, i2 });
+        }
+    }
+
+    mesh.indexCount = (GLsizei)indices.size();
+    mesh.vertexCount = vertices.size() / 6;
+
+    if (!mesh.vertexArray.create() || !mesh.vertexBuffer.create() || !mesh.indexBuffer.create()) {
+        return false;
+    }
+    glBindVertexArray(mesh.vertexArray.get());
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    return true;
+}
+
+// Returns seconds per draw (median over the iterations of batch draws each)
+static double timeVariant(ShaderProgram& shader, bool uniformNormalMatrix, const GridMesh& mesh, int iterations, int batch) {
+    shader.use();
+    UniformHandle modelUniform = shader.getUniform("model");
+    UniformHandle viewProjectionUniform = shader.getUniform("viewProjection");
+    UniformHandle normalMatrixUniform = shader.getUniform("normalMatrix");
+
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    shader.set(viewProjectionUniform, viewProjection);
+
+    glBindVertexArray(mesh.vertexArray.get());
+    std::vector<double> samples;
+    for (int i = 0; i < iterations + 1; i++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int draw = 0; draw < batch; draw++) {
+            // Non-uniform scale, so the normal matrix is not just the rotation
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), 0.01f * (i * batch + draw), glm::vec3(0.3f, 1.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(1.0f, 0.5f, 2.0f));
+            shader.set(modelUniform, model);
+            if (uniformNormalMatrix) {
+                shader.set(normalMatrixUniform, glm::transpose(glm::inverse(glm::mat3(model))));
+            }
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glFinish();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // The first batch includes shader compilation in some drivers
+        if (i > 0) {
+            samples.push_back(elapsed.count() / batch);
+        }
+    }
+    glBindVertexArray(0);
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    int grid = 1024;
+    int iterations = 20;
+    int batch = 10;
+    bool headless = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--grid" && i + 1 < argc) {
+            grid = std::atoi(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch = std::atoi(argv[++i]);
+        } else if (arg == "--window") {
+            headless = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--grid N] [--iterations M] [--batch K] [--window]" << std::endl;
+            return -1;
+        }
+    }
+    if (grid < 1 || iterations < 1 || batch < 1) {
+        std::cerr << "--grid, --iterations and --batch must be positive" << std::endl;
+        return -1;
+    }
+
+    GLContext context;
+    ContextConfig config;
+    config.backend = headless ? ContextBackend::Headless : ContextBackend::Window;
+    config.title = "Normal Matrix Benchmark";
+    config.vsync = false;
+    if (!context.create(config)) {
+        return -1;
+    }
+
+    ShaderProgram perVertex;
+    ShaderProgram perObject;
+    if (!perVertex.create(vertexShaderSource, fragmentShaderSource) ||
+        !perObject.create(vertexShaderSource, fragmentShaderSource, "#define NORMAL_MATRIX_UNIFORM\n")) {
+        return -1;
+    }
+
+    GridMesh mesh;
+    if (!createGridMesh(grid, mesh)) {
+        std::cerr << "Failed to create the grid mesh" << std::endl;
+        return -1;
+    }
+
+    // Tiny viewport: nearly all triangles are culled to zero pixels, so vertex work dominates
+    glViewport(0, 0, 16, 16);
+    glEnable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    double inverseSeconds = timeVariant(perVertex, false, mesh, iterations, batch);
+    double uniformSeconds = timeVariant(perObject, true, mesh, iterations, batch);
+
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+    std::cout << "Mesh: " << mesh.vertexCount << " vertices, " << mesh.indexCount / 3 << " triangles" << std::endl;
+    std::cout << "  per-vertex inverse(model): " << inverseSeconds * 1000.0 << " ms/draw, "
+              << mesh.vertexCount / inverseSeconds / 1e6 << " Mverts/s" << std::endl;
+    std::cout << "  normalMatrix uniform:      " << uniformSeconds * 1000.0 << " ms/draw, "
+              << mesh.vertexCount / uniformSeconds / 1e6 << " Mverts/s" << std::endl;
+    std::cout << "  speedup: " << inverseSeconds / uniformSeconds << "x" << std::endl;
+
+    perVertex.destroy();
+    perObject.destroy();
+    return 0;
+}
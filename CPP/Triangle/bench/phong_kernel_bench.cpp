@@ -0,0 +1,112 @@
+// Shading throughput of the software rasterizer's Phong kernels (scalar,
+// SSE4.1, AVX2) on the same fragments, without rasterization overhead.
+// Also checks that every SIMD kernel matches the scalar one to within one
+// 8-bit step per channel.
+//
+//   phong_kernel_bench [--fragments N] [--iterations M]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "softraster/phong_kernel.h"
+
+// Fragments spread over a lit, slightly curved patch facing the camera, so
+// the diffuse and specular terms cover their whole range
+static std::vector<PhongBatch> createBatches(size_t batchCount) {
+    std::vector<PhongBatch> batches(batchCount);
+    size_t side = (size_t)std::ceil(std::sqrt((double)batchCount * kPhongBatchSize));
+    for (size_t i = 0; i < batchCount * kPhongBatchSize; i++) {
+        float u = (float)(i % side) / side * 2.0f - 1.0f;
+        float v = (float)(i / side) / side * 2.0f - 1.0f;
+        PhongBatch& batch = batches[i / kPhongBatchSize];
+        int lane = (int)(i % kPhongBatchSize);
+        batch.positionX[lane] = u;
+        batch.positionY[lane] = v;
+        batch.positionZ[lane] = 0.0f;
+        batch.normalX[lane] = u * 0.5f;
+        batch.normalY[lane] = v * 0.5f;
+        batch.normalZ[lane] = 1.0f;
+    }
+    return batches;
+}
+
+// Returns seconds per pass over all batches (median over the iterations)
+static double timeKernel(PhongKernel kernel, const PhongUniforms& uniforms, const std::vector<PhongBatch>& batches,
+                         std::vector<uint32_t>& colors, int iterations) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < batches.size(); b++) {
+            kernel(uniforms, batches[b], &colors[b * kPhongBatchSize]);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static int maxChannelDifference(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    int result = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            int difference = std::abs((int)((a[i] >> shift) & 0xff) - (int)((b[i] >> shift) & 0xff));
+            result = std::max(result, difference);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    long fragments = 1 << 20;
+    int iterations = 20;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fragments" && i + 1 < argc) {
+            fragments = std::atol(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--fragments N] [--iterations M]" << std::endl;
+            return -1;
+        }
+    }
+    if (fragments < 1 || iterations < 1) {
+        std::cerr << "--fragments and --iterations must be positive" << std::endl;
+        return -1;
+    }
+
+    size_t batchCount = (size_t)(fragments + kPhongBatchSize - 1) / kPhongBatchSize;
+    std::vector<PhongBatch> batches = createBatches(batchCount);
+    PhongUniforms uniforms;
+    size_t fragmentCount = batchCount * kPhongBatchSize;
+
+    SimdLevel best = detectSimdLevel();
+    std::cout << "Best supported kernel: " << simdLevelName(best) << std::endl;
+    std::cout << "Fragments: " << fragmentCount << std::endl;
+
+    std::vector<uint32_t> reference(fragmentCount);
+    double scalarSeconds = timeKernel(getPhongKernel(SimdLevel::Scalar), uniforms, batches, reference, iterations);
+    std::cout << "  scalar: " << fragmentCount / scalarSeconds / 1e6 << " Mfragments/s" << std::endl;
+
+    int result = 0;
+    for (SimdLevel level : { SimdLevel::SSE41, SimdLevel::AVX2 }) {
+        if (level > best) {
+            continue;
+        }
+        std::vector<uint32_t> colors(fragmentCount);
+        double seconds = timeKernel(getPhongKernel(level), uniforms, batches, colors, iterations);
+        int difference = maxChannelDifference(reference, colors);
+        std::cout << "  " << simdLevelName(level) << ": " << fragmentCount / seconds / 1e6 << " Mfragments/s, "
+                  << scalarSeconds / seconds << "x scalar, max difference " << difference << std::endl;
+        if (difference > 1) {
+            std::cerr << simdLevelName(level) << " kernel differs from the scalar kernel by more than one step" << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,176 @@
+// PNG decode time of stb_image against decodePng() (serial and with inflate
+// and unfiltering on two threads) and against the texture loader's path
+// (loadImageFile(): mapped file + decodePng()), on a rose.png-sized and an
+// 8K generated image or on given files. Also checks that every path decodes
+// the same pixels as stb_image.
+//
+//   png_decode_bench [--image FILE]... [--large N] [--iterations M]
+//
+// Without --image the generated images are written next to the working
+// directory as png_bench_<size>.png and removed afterwards.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <functional>
+#include <thread>
+#include "core/png_decoder.h"
+#include "core/image_reader.h"
+#include "core/image_writer.h"
+#include "stb_image.h"
+
+// Texture-like content: smooth shading, a tiled pattern and a little noise,
+// so the file compresses about as well as a photo-sourced texture
+static std::vector<unsigned char> createImage(int size) {
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    unsigned int noise = 12345;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char* p = &pixels[((size_t)y * size + x) * 4];
+            float u = (float)x / size, v = (float)y / size;
+            noise = noise * 1664525u + 1013904223u;
+            int grain = (int)(noise >> 29) - 4;
+            bool tile = ((x / 64 + y / 64) & 1) != 0;
+            p[0] = (unsigned char)std::min(255, std::max(0, (int)(200.0f * u) + grain + (tile ? 40 : 0)));
+            p[1] = (unsigned char)std::min(255, std::max(0, (int)(127.5f + 100.0f * std::sin(v * 9.0f)) + grain));
+            p[2] = (unsigned char)std::min(255, std::max(0, (int)(255.0f * (1.0f - v)) + grain));
+            p[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+static std::vector<unsigned char> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Returns milliseconds per decode (median over the iterations, after one warm-up run)
+static double timeMs(const std::function<unsigned char*()>& decode, int iterations) {
+    std::free(decode());
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        unsigned char* pixels = decode();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+        std::free(pixels);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Runs every decode path on one file; false if one of them differs from stb_image
+static bool benchmarkFile(const std::string& path, int iterations) {
+    std::vector<unsigned char> data = readFile(path);
+    int width = 0, height = 0, channels = 0;
+    unsigned char* reference = stbi_load_from_memory(data.data(), (int)data.size(), &width, &height, &channels, 0);
+    if (!reference) {
+        std::cerr << "Failed to load " << path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    size_t bytes = (size_t)width * height * channels;
+    double megapixels = (double)width * height / 1.0e6;
+    std::cout << path << ": " << width << "x" << height << ", " << channels << " channels, "
+              << data.size() / 1024 << " KiB" << std::endl;
+
+    bool result = true;
+    auto check = [&](const char* name, unsigned char* pixels) {
+        if (!pixels || std::memcmp(pixels, reference, bytes) != 0) {
+            std::cerr << "  " << name << (pixels ? " decodes different pixels" : " cannot decode this file") << std::endl;
+            result = false;
+        }
+        std::free(pixels);
+    };
+
+    int w, h, c;
+    PngDecodeOptions serial;
+    serial.threads = 1;
+    PngDecodeOptions pipelined;
+    pipelined.threads = 2;
+    std::string error;
+    check("decodePng (serial)", decodePng(data.data(), data.size(), w, h, c, 0, serial));
+    check("decodePng (pipelined)", decodePng(data.data(), data.size(), w, h, c, 0, pipelined));
+    check("loadImageFile", loadImageFile(path, w, h, c, 0, false, error));
+
+    double stbFile = timeMs([&] { return stbi_load(path.c_str(), &w, &h, &c, 0); }, iterations);
+    double stbMemory = timeMs([&] { return stbi_load_from_memory(data.data(), (int)data.size(), &w, &h, &c, 0); }, iterations);
+    double serialMs = timeMs([&] { return decodePng(data.data(), data.size(), w, h, c, 0, serial); }, iterations);
+    double pipelinedMs = timeMs([&] { return decodePng(data.data(), data.size(), w, h, c, 0, pipelined); }, iterations);
+    double loaderMs = timeMs([&] { return loadImageFile(path, w, h, c, 0, false, error); }, iterations);
+
+    auto report = [&](const char* name, double ms) {
+        std::cout << "  " << name << ms << " ms, " << megapixels / ms * 1000.0 << " Mpixels/s, "
+                  << stbFile / ms << "x stbi_load" << std::endl;
+    };
+    report("stbi_load (stdio):           ", stbFile);
+    report("stbi_load_from_memory:       ", stbMemory);
+    report("decodePng, 1 thread:         ", serialMs);
+    report("decodePng, inflate thread:   ", pipelinedMs);
+    report("loadImageFile (mapped):      ", loaderMs);
+
+    stbi_image_free(reference);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> images;
+    int large = 8192;
+    int iterations = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--image" && i + 1 < argc) {
+            images.push_back(argv[++i]);
+        } else if (arg == "--large" && i + 1 < argc) {
+            large = std::atoi(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--image FILE]... [--large N] [--iterations M]" << std::endl;
+            return -1;
+        }
+    }
+    if (large < 0 || large > 16384 || iterations < 1) {
+        std::cerr << "--large must be between 0 and 16384 and --iterations positive" << std::endl;
+        return -1;
+    }
+
+    // rose.png is 445x500; the large image stands in for an 8K texture
+    std::vector<std::string> generated;
+    if (images.empty()) {
+        std::vector<int> sizes = { 512 };
+        if (large > 0) {
+            sizes.push_back(large);
+        }
+        for (int size : sizes) {
+            std::string path = "png_bench_" + std::to_string(size) + ".png";
+            std::vector<unsigned char> pixels = createImage(size);
+            std::cout << "Writing " << path << "..." << std::endl;
+            if (!writePng(path, size, size, 4, pixels.data(), (ptrdiff_t)size * 4)) {
+                return -1;
+            }
+            generated.push_back(path);
+        }
+        images = generated;
+    }
+
+    std::cout << "Hardware threads: " << std::max(1u, std::thread::hardware_concurrency()) << std::endl;
+    int result = 0;
+    for (const std::string& path : images) {
+        if (!benchmarkFile(path, iterations)) {
+            result = 1;
+        }
+    }
+    for (const std::string& path : generated) {
+        std::remove(path.c_str());
+    }
+    return result;
+}
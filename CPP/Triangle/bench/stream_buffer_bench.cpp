@@ -0,0 +1,208 @@
+// Per-frame cost of streaming dynamic vertices to the GPU. Every frame
+// rewrites the positions of a grid of triangles and draws them, through:
+// glBufferSubData into one buffer, orphaning (glBufferData(nullptr) then
+// glBufferSubData), and a StreamBuffer with unsynchronized mapping and, when
+// the driver has buffer storage, with persistent mapping. Also checks that
+// every path renders the same image.
+//
+//   stream_buffer_bench [--triangles N] [--frames M] [--regions R] [--window]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <glad/glad.h>
+#include "core/gl_context.h"
+#include "core/gl_objects.h"
+#include "core/gl_extensions.h"
+#include "core/shader_program.h"
+#include "core/stream_buffer.h"
+
+const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+void main() {
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(1.0, 0.6, 0.2, 1.0);
+}
+)";
+
+// Triangles on a square grid over clip space, each wobbling with its own phase
+static void writeVertices(int triangles, int frame, float* out) {
+    int columns = std::max(1, (int)std::ceil(std::sqrt((double)triangles)));
+    float cell = 2.0f / columns;
+    float time = frame * 0.05f;
+    for (int i = 0; i < triangles; i++) {
+        float x = -1.0f + (i % columns + 0.5f) * cell;
+        float y = -1.0f + (i / columns + 0.5f) * cell;
+        float angle = time + i * 0.37f;
+        float size = cell * 0.45f;
+        for (int k = 0; k < 3; k++) {
+            float corner = angle + k * 2.0943951f;
+            out[(i * 3 + k) * 2] = x + size * std::cos(corner);
+            out[(i * 3 + k) * 2 + 1] = y + size * std::sin(corner);
+        }
+    }
+}
+
+// Returns milliseconds per frame (median over the frames, after a few warm-up frames)
+static double timeFrames(GLContext& context, int frames, const std::function<void(int)>& frame) {
+    const int warmup = 10;
+    std::vector<double> samples;
+    for (int i = 0; i < warmup + frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        frame(i);
+        context.swapBuffers();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (i >= warmup) {
+            samples.push_back(elapsed.count());
+        }
+    }
+    glFinish();
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static std::vector<unsigned char> readFrame(int width, int height) {
+    std::vector<unsigned char> pixels((size_t)width * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+int main(int argc, char** argv) {
+    int triangles = 100000;
+    int frames = 200;
+    int regions = 3;
+    bool headless = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--triangles" && i + 1 < argc) {
+            triangles = std::atoi(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--regions" && i + 1 < argc) {
+            regions = std::atoi(argv[++i]);
+        } else if (arg == "--window") {
+            headless = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--triangles N] [--frames M] [--regions R] [--window]" << std::endl;
+            return -1;
+        }
+    }
+    if (triangles < 1 || triangles > (1 << 24) || frames < 1 || regions < 1) {
+        std::cerr << "--triangles must be between 1 and 16777216, --frames and --regions positive" << std::endl;
+        return -1;
+    }
+
+    GLContext context;
+    ContextConfig config;
+    config.backend = headless ? ContextBackend::Headless : ContextBackend::Window;
+    config.title = "Stream Buffer Benchmark";
+    config.vsync = false;
+    if (!context.create(config)) {
+        return -1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+    size_t bytes = (size_t)triangles * 3 * 2 * sizeof(float);
+    std::cout << triangles << " triangles, " << bytes / 1024 << " KiB of vertices per frame, " << regions
+              << " regions" << std::endl;
+
+    ShaderProgram shader;
+    if (!shader.create(vertexShaderSource, fragmentShaderSource)) {
+        return -1;
+    }
+    shader.use();
+    GLVertexArray vao;
+    vao.create();
+    glBindVertexArray(vao.get());
+    glEnableVertexAttribArray(0);
+    glViewport(0, 0, context.getWidth(), context.getHeight());
+
+    std::vector<float> vertices((size_t)triangles * 3 * 2);
+    auto draw = [&](GLuint buffer, GLintptr offset) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
+        glDrawArrays(GL_TRIANGLES, 0, triangles * 3);
+    };
+
+    int result = 0;
+    std::vector<unsigned char> reference;
+    auto report = [&](const char* name, double ms, int waits) {
+        std::cout << "  " << name << ms << " ms/frame";
+        if (waits >= 0) {
+            std::cout << ", " << waits << " waits for the GPU";
+        }
+        std::cout << std::endl;
+        // Every path draws the same last frame
+        std::vector<unsigned char> pixels = readFrame(context.getWidth(), context.getHeight());
+        if (reference.empty()) {
+            reference = pixels;
+        } else if (pixels != reference) {
+            std::cerr << name << "renders a different image than glBufferSubData" << std::endl;
+            result = 1;
+        }
+    };
+
+    GLBuffer staticBuffer;
+    staticBuffer.create();
+    glBindBuffer(GL_ARRAY_BUFFER, staticBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, nullptr, GL_DYNAMIC_DRAW);
+    report("glBufferSubData:                ", timeFrames(context, frames, [&](int frame) {
+               writeVertices(triangles, frame, vertices.data());
+               glBindBuffer(GL_ARRAY_BUFFER, staticBuffer.get());
+               glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, vertices.data());
+               draw(staticBuffer.get(), 0);
+           }), -1);
+
+    report("orphan + glBufferSubData:       ", timeFrames(context, frames, [&](int frame) {
+               writeVertices(triangles, frame, vertices.data());
+               glBindBuffer(GL_ARRAY_BUFFER, staticBuffer.get());
+               glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, nullptr, GL_DYNAMIC_DRAW);
+               glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, vertices.data());
+               draw(staticBuffer.get(), 0);
+           }), -1);
+
+    // The stream buffer paths generate straight into the mapping, with no staging copy
+    for (StreamMapping mapping : { StreamMapping::Unsynchronized, StreamMapping::Persistent }) {
+        if (mapping == StreamMapping::Persistent && !getGLExtensions().bufferStorage) {
+            std::cout << "  StreamBuffer, persistent:       not supported by this driver" << std::endl;
+            continue;
+        }
+        StreamBuffer stream;
+        if (!stream.create(GL_ARRAY_BUFFER, bytes, regions, mapping)) {
+            result = 1;
+            continue;
+        }
+        double ms = timeFrames(context, frames, [&](int frame) {
+            stream.beginFrame();
+            StreamAllocation allocation = stream.allocate(bytes);
+            if (!allocation.data) {
+                return;
+            }
+            writeVertices(triangles, frame, (float*)allocation.data);
+            stream.commit();
+            draw(stream.get(), allocation.offset);
+            stream.endFrame();
+        });
+        std::string name = std::string("StreamBuffer, ") + streamMappingName(mapping) + ":";
+        name.resize(32, ' ');
+        report(name.c_str(), ms, stream.getWaitCount());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return result;
+}
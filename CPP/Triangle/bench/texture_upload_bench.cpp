@@ -0,0 +1,168 @@
+// Texture upload throughput per source format and conversion path.
+//
+// CPU side: the RGB to RGBA expansion kernels at each SIMD level (checked
+// against the scalar one). GL side: glTexSubImage2D + glFinish of the same
+// image as RGB8 handed to the driver as is, as RGBA8 expanded first (scalar
+// and SIMD, conversion included in the time), as native RGBA8, and as R8 with
+// tight and 4-byte aligned rows. Use an odd --size width to see the
+// unaligned-row cases.
+//
+//   texture_upload_bench [--size WxH] [--iterations M] [--window]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <glad/glad.h>
+#include "core/gl_context.h"
+#include "core/texture_upload.h"
+#include "core/upload_kernels.h"
+
+static std::vector<unsigned char> createImage(int width, int height, int channels) {
+    std::vector<unsigned char> pixels((size_t)width * height * channels);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = (unsigned char)(i * 7 + i / 4099);
+    }
+    return pixels;
+}
+
+// Returns milliseconds per call (median over the iterations, after one warm-up call)
+static double timeMs(const std::function<void()>& run, int iterations) {
+    run();
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static void report(const char* name, double ms, int width, int height) {
+    std::cout << "  " << name << ms << " ms, " << (double)width * height / ms / 1000.0 << " Mpixels/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int width = 2048, height = 2048;
+    int iterations = 20;
+    bool headless = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            std::string size = argv[++i];
+            size_t separator = size.find('x');
+            if (separator == std::string::npos) {
+                std::cerr << "--size expects WxH" << std::endl;
+                return -1;
+            }
+            width = std::atoi(size.substr(0, separator).c_str());
+            height = std::atoi(size.substr(separator + 1).c_str());
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (arg == "--window") {
+            headless = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--size WxH] [--iterations M] [--window]" << std::endl;
+            return -1;
+        }
+    }
+    if (width < 1 || height < 1 || width > 16384 || height > 16384 || iterations < 1) {
+        std::cerr << "--size must be between 1x1 and 16384x16384 and --iterations positive" << std::endl;
+        return -1;
+    }
+
+    std::vector<unsigned char> rgb = createImage(width, height, 3);
+    std::vector<unsigned char> grey = createImage(width, height, 1);
+    size_t pixelCount = (size_t)width * height;
+    std::vector<unsigned char> reference(pixelCount * 4);
+    std::vector<unsigned char> rgba(pixelCount * 4);
+    std::vector<unsigned char> paddedGrey(getUploadSize(width, height, 1));
+
+    SimdLevel best = detectSimdLevel();
+    std::cout << "Image: " << width << "x" << height << ", best supported kernel: " << simdLevelName(best) << std::endl;
+
+    int result = 0;
+    std::cout << "RGB to RGBA expansion:" << std::endl;
+    double scalarMs = timeMs([&] { expandRgbScalar(rgb.data(), reference.data(), pixelCount); }, iterations);
+    report("scalar: ", scalarMs, width, height);
+    for (SimdLevel level : { SimdLevel::SSE41, SimdLevel::AVX2 }) {
+        if (level > best) {
+            continue;
+        }
+        ExpandRgbKernel kernel = getExpandRgbKernel(level);
+        double ms = timeMs([&] { kernel(rgb.data(), rgba.data(), pixelCount); }, iterations);
+        bool matches = std::memcmp(rgba.data(), reference.data(), rgba.size()) == 0;
+        std::cout << "  " << simdLevelName(level) << ": " << ms << " ms, " << (double)pixelCount / ms / 1000.0
+                  << " Mpixels/s, " << scalarMs / ms << "x scalar" << (matches ? "" : " (MISMATCH)") << std::endl;
+        if (!matches) {
+            std::cerr << simdLevelName(level) << " expansion differs from the scalar one" << std::endl;
+            result = 1;
+        }
+    }
+
+    GLContext context;
+    ContextConfig config;
+    config.backend = headless ? ContextBackend::Headless : ContextBackend::Window;
+    config.title = "Texture Upload Benchmark";
+    config.vsync = false;
+    if (!context.create(config)) {
+        return -1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    // Storage is allocated once per format, so only the transfer is timed
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+    auto upload = [&](GLuint texture, GLenum format, int alignment, const unsigned char* data) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+        glFinish();
+    };
+
+    std::cout << "Upload (glTexSubImage2D + glFinish):" << std::endl;
+    report("RGB8, alignment 1:            ",
+           timeMs([&] { upload(textures[0], GL_RGB, 1, rgb.data()); }, iterations), width, height);
+    report("RGBA8, scalar expansion:      ", timeMs([&] {
+               expandRgbScalar(rgb.data(), rgba.data(), pixelCount);
+               upload(textures[0], GL_RGBA, 4, rgba.data());
+           }, iterations), width, height);
+    report("RGBA8, convertForUpload():    ", timeMs([&] {
+               convertForUpload(rgb.data(), width, height, 3, rgba.data());
+               upload(textures[0], GL_RGBA, 4, rgba.data());
+           }, iterations), width, height);
+    report("RGBA8, native:                ",
+           timeMs([&] { upload(textures[0], GL_RGBA, 4, rgba.data()); }, iterations), width, height);
+    report("R8, tight rows, alignment 1:  ",
+           timeMs([&] { upload(textures[1], GL_RED, 1, grey.data()); }, iterations), width, height);
+    report("R8, convertForUpload():       ", timeMs([&] {
+               convertForUpload(grey.data(), width, height, 1, paddedGrey.data());
+               upload(textures[1], GL_RED, 4, paddedGrey.data());
+           }, iterations), width, height);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // The uploaded RGBA must read back as the expanded RGB
+    std::vector<unsigned char> readBack(pixelCount * 4);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    convertForUpload(rgb.data(), width, height, 3, rgba.data());
+    upload(textures[0], GL_RGBA, 4, rgba.data());
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, readBack.data());
+    if (std::memcmp(readBack.data(), reference.data(), readBack.size()) != 0) {
+        std::cerr << "Uploaded RGBA texture does not match the source image" << std::endl;
+        result = 1;
+    }
+
+    glDeleteTextures(2, textures);
+    return result;
+}
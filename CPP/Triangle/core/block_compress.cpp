@@ -0,0 +1,495 @@
+#include "block_compress.h"
+#include "block_kernels.h"
+#include "row_bands.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Endpoint refinement rounds after the initial principal-axis fit
+static const int refineIterations = 2;
+
+// BC7 4-bit index weights, in 64ths
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+size_t getBlockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+size_t getCompressedSize(BlockFormat format, int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+}
+
+const char* blockFormatName(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1:
+        return "bc1";
+    case BlockFormat::BC3:
+        return "bc3";
+    default:
+        return "bc7";
+    }
+}
+
+static void loadBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, BlockTexels& texels) {
+    for (int y = 0; y < 4; y++) {
+        int sourceY = std::min(blockY * 4 + y, height - 1);
+        for (int x = 0; x < 4; x++) {
+            int sourceX = std::min(blockX * 4 + x, width - 1);
+            const unsigned char* p = rgba + ((size_t)sourceY * width + sourceX) * 4;
+            for (int c = 0; c < 4; c++) {
+                texels.channel[c][y * 4 + x] = p[c];
+            }
+        }
+    }
+}
+
+// Two endpoints spanning the texels along their principal axis (power
+// iteration on the covariance of the first channelCount channels)
+static void fitEndpoints(const BlockTexels& texels, int channelCount, float* endpoint0, float* endpoint1) {
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int c = 0; c < channelCount; c++) {
+        for (int i = 0; i < 16; i++) {
+            mean[c] += texels.channel[c][i];
+        }
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int a = 0; a < channelCount; a++) {
+            for (int b = 0; b < channelCount; b++) {
+                covariance[a][b] += (texels.channel[a][i] - mean[a]) * (texels.channel[b][i] - mean[b]);
+            }
+        }
+    }
+
+    // Start from the covariance column of the channel that varies most, which
+    // is never orthogonal to the principal axis; a uniform block keeps a zero axis
+    int widest = 0;
+    for (int c = 1; c < channelCount; c++) {
+        if (covariance[c][c] > covariance[widest][widest]) {
+            widest = c;
+        }
+    }
+    float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (covariance[widest][widest] > 0.0f) {
+        for (int c = 0; c < channelCount; c++) {
+            axis[c] = covariance[widest][c];
+        }
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float length2 = 0.0f;
+            for (int a = 0; a < channelCount; a++) {
+                for (int b = 0; b < channelCount; b++) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                length2 += next[a] * next[a];
+            }
+            float scale = 1.0f / std::sqrt(length2);
+            for (int c = 0; c < channelCount; c++) {
+                axis[c] = next[c] * scale;
+            }
+        }
+    }
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channelCount; c++) {
+            t += (texels.channel[c][i] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < channelCount; c++) {
+        endpoint0[c] = std::min(std::max(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+        endpoint1[c] = std::min(std::max(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+    }
+}
+
+// Least-squares endpoints for fixed indices, where index i blends
+// (1 - weights[i]) * endpoint0 + weights[i] * endpoint1. Leaves the endpoints
+// alone when every texel uses the same weight.
+static void refineEndpoints(const BlockTexels& texels, int channelCount, const unsigned char* indices,
+                            const float* weights, float* endpoint0, float* endpoint1) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; i++) {
+        float b = weights[indices[i]];
+        float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channelCount; c++) {
+            ax[c] += a * texels.channel[c][i];
+            bx[c] += b * texels.channel[c][i];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) {
+        return;
+    }
+    for (int c = 0; c < channelCount; c++) {
+        endpoint0[c] = std::min(std::max((bb * ax[c] - ab * bx[c]) / determinant, 0.0f), 255.0f);
+        endpoint1[c] = std::min(std::max((aa * bx[c] - ab * ax[c]) / determinant, 0.0f), 255.0f);
+    }
+}
+
+// RGB565 with the bit replication decoders use to expand it
+static uint16_t quantize565(const float* color) {
+    int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+    int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+    int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void expand565(uint16_t packed, int* color) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+static void writeU16(unsigned char* out, uint16_t value) {
+    out[0] = (unsigned char)(value & 0xff);
+    out[1] = (unsigned char)(value >> 8);
+}
+
+// BC1 colour block in four-colour mode (color0 > color1); a block whose
+// endpoints quantize to the same colour uses only index 0
+static void encodeColorBlock(const BlockTexels& texels, FitIndicesKernel fit, unsigned char* out) {
+    // Palette positions of the four indices between color0 and color1
+    static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    float endpoint0[4], endpoint1[4];
+    fitEndpoints(texels, 3, endpoint0, endpoint1);
+
+    float bestError = 3.4e38f;
+    for (int iteration = 0; iteration <= refineIterations; iteration++) {
+        uint16_t color0 = quantize565(endpoint0);
+        uint16_t color1 = quantize565(endpoint1);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+            std::swap(endpoint0, endpoint1);
+        }
+
+        int expanded0[3], expanded1[3];
+        expand565(color0, expanded0);
+        expand565(color1, expanded1);
+        float palette[4][4] = {};
+        for (int c = 0; c < 3; c++) {
+            for (int p = 0; p < 4; p++) {
+                palette[p][c] = expanded0[c] + (expanded1[c] - expanded0[c]) * weights[p];
+            }
+        }
+
+        unsigned char indices[16];
+        float error = fit(texels, palette, color0 == color1 ? 1 : 4, 0, 3, indices);
+        if (error < bestError) {
+            bestError = error;
+            uint32_t bits = 0;
+            for (int i = 0; i < 16; i++) {
+                bits |= (uint32_t)indices[i] << (i * 2);
+            }
+            writeU16(out, color0);
+            writeU16(out + 2, color1);
+            std::memcpy(out + 4, &bits, 4);
+        }
+        if (color0 == color1 || error == 0.0f) {
+            break;
+        }
+        refineEndpoints(texels, 3, indices, weights, endpoint0, endpoint1);
+    }
+}
+
+// BC4 block for the alpha channel: alpha0 > alpha1 selects eight levels
+static void encodeAlphaBlock(const BlockTexels& texels, FitIndicesKernel fit, unsigned char* out) {
+    float low = texels.channel[3][0], high = texels.channel[3][0];
+    for (int i = 1; i < 16; i++) {
+        low = std::min(low, texels.channel[3][i]);
+        high = std::max(high, texels.channel[3][i]);
+    }
+    int alpha0 = (int)high, alpha1 = (int)low;
+
+    unsigned char indices[16] = {};
+    if (alpha0 != alpha1) {
+        float palette[8][4] = {};
+        palette[0][3] = (float)alpha0;
+        palette[1][3] = (float)alpha1;
+        for (int p = 2; p < 8; p++) {
+            palette[p][3] = ((8 - p) * alpha0 + (p - 1) * alpha1) / 7.0f;
+        }
+        fit(texels, palette, 8, 3, 1, indices);
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= (uint64_t)indices[i] << (i * 3);
+    }
+    out[0] = (unsigned char)alpha0;
+    out[1] = (unsigned char)alpha1;
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = (unsigned char)(bits >> (i * 8));
+    }
+}
+
+// Writes fields least significant bit first, as BC7 packs them
+struct BitWriter {
+    unsigned char* out;
+    int position;
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            if ((value >> i) & 1) {
+                out[position / 8] |= (unsigned char)(1 << (position % 8));
+            }
+        }
+    }
+};
+
+struct BitReader {
+    const unsigned char* in;
+    int position;
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; i++, position++) {
+            value |= (uint32_t)((in[position / 8] >> (position % 8)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+// Seven bits per channel plus one low bit shared by the endpoint's channels;
+// picks the low bit that lands closer
+static void quantizeBc7Endpoint(const float* endpoint, int* quantized, int& pBit) {
+    float bestError = 3.4e38f;
+    for (int p = 0; p < 2; p++) {
+        int candidate[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            candidate[c] = std::min(std::max((int)((endpoint[c] - p) / 2.0f + 0.5f), 0), 127);
+            float d = (float)(candidate[c] * 2 + p) - endpoint[c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pBit = p;
+            std::copy(candidate, candidate + 4, quantized);
+        }
+    }
+}
+
+static void encodeBc7Block(const BlockTexels& texels, FitIndicesKernel fit, unsigned char* out) {
+    float weights[16];
+    for (int i = 0; i < 16; i++) {
+        weights[i] = bc7Weights[i] / 64.0f;
+    }
+
+    float endpoint0[4], endpoint1[4];
+    fitEndpoints(texels, 4, endpoint0, endpoint1);
+
+    float bestError = 3.4e38f;
+    int best0[4] = {}, best1[4] = {}, bestP0 = 0, bestP1 = 0;
+    unsigned char bestIndices[16] = {};
+    for (int iteration = 0; iteration <= refineIterations; iteration++) {
+        int quantized0[4], quantized1[4], p0, p1;
+        quantizeBc7Endpoint(endpoint0, quantized0, p0);
+        quantizeBc7Endpoint(endpoint1, quantized1, p1);
+
+        float palette[16][4];
+        for (int c = 0; c < 4; c++) {
+            int value0 = quantized0[c] * 2 + p0;
+            int value1 = quantized1[c] * 2 + p1;
+            for (int p = 0; p < 16; p++) {
+                palette[p][c] = (float)(((64 - bc7Weights[p]) * value0 + bc7Weights[p] * value1 + 32) >> 6);
+            }
+        }
+
+        unsigned char indices[16];
+        float error = fit(texels, palette, 16, 0, 4, indices);
+        if (error < bestError) {
+            bestError = error;
+            std::copy(quantized0, quantized0 + 4, best0);
+            std::copy(quantized1, quantized1 + 4, best1);
+            bestP0 = p0;
+            bestP1 = p1;
+            std::copy(indices, indices + 16, bestIndices);
+        }
+        if (error == 0.0f) {
+            break;
+        }
+        refineEndpoints(texels, 4, indices, weights, endpoint0, endpoint1);
+    }
+
+    // The first texel's index is stored without its top bit, so it must be
+    // below 8; the weights are symmetric, so swapping the endpoints and
+    // mirroring the indices gives the same colours
+    if (bestIndices[0] >= 8) {
+        std::swap(best0, best1);
+        std::swap(bestP0, bestP1);
+        for (int i = 0; i < 16; i++) {
+            bestIndices[i] = (unsigned char)(15 - bestIndices[i]);
+        }
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer = { out, 0 };
+    writer.write(1 << 6, 7);  // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.write((uint32_t)best0[c], 7);
+        writer.write((uint32_t)best1[c], 7);
+    }
+    writer.write((uint32_t)bestP0, 1);
+    writer.write((uint32_t)bestP1, 1);
+    for (int i = 0; i < 16; i++) {
+        writer.write(bestIndices[i], i == 0 ? 3 : 4);
+    }
+}
+
+bool compressImage(const unsigned char* rgba, int width, int height, BlockFormat format,
+                   const BlockCompressOptions& options, std::vector<unsigned char>& blocks) {
+    if (!rgba || width < 1 || height < 1) {
+        return false;
+    }
+    TraceZone zone("compress blocks", "texture");
+
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t blockBytes = getBlockBytes(format);
+    blocks.assign(getCompressedSize(format, width, height), 0);
+    FitIndicesKernel fit = getFitIndicesKernel(std::min(detectSimdLevel(), options.maxSimd));
+
+    auto encodeRows = [&](int first, int last) {
+        BlockTexels texels;
+        for (int blockY = first; blockY < last; blockY++) {
+            for (int blockX = 0; blockX < blocksX; blockX++) {
+                unsigned char* out = &blocks[((size_t)blockY * blocksX + blockX) * blockBytes];
+                loadBlock(rgba, width, height, blockX, blockY, texels);
+                if (format == BlockFormat::BC1) {
+                    encodeColorBlock(texels, fit, out);
+                } else if (format == BlockFormat::BC3) {
+                    encodeAlphaBlock(texels, fit, out);
+                    encodeColorBlock(texels, fit, out + 8);
+                } else {
+                    encodeBc7Block(texels, fit, out);
+                }
+            }
+        }
+    };
+
+    // A handful of blocks is not worth waking threads for
+    forEachRowBand(blocksY, blocksX * blocksY >= 256 ? options.threads : 1, encodeRows);
+    return true;
+}
+
+static void decodeColorBlock(const unsigned char* in, bool allowThreeColor, unsigned char (*texels)[4]) {
+    uint16_t color0 = (uint16_t)(in[0] | (in[1] << 8));
+    uint16_t color1 = (uint16_t)(in[2] | (in[3] << 8));
+    int palette[4][4];
+    expand565(color0, palette[0]);
+    expand565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    bool fourColor = color0 > color1 || !allowThreeColor;
+    for (int c = 0; c < 3; c++) {
+        if (fourColor) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = fourColor ? 255 : 0;
+
+    uint32_t bits;
+    std::memcpy(&bits, in + 4, 4);
+    for (int i = 0; i < 16; i++) {
+        const int* color = palette[(bits >> (i * 2)) & 3];
+        for (int c = 0; c < 4; c++) {
+            texels[i][c] = (unsigned char)color[c];
+        }
+    }
+}
+
+static void decodeAlphaBlock(const unsigned char* in, unsigned char (*texels)[4]) {
+    int alpha[8];
+    alpha[0] = in[0];
+    alpha[1] = in[1];
+    if (alpha[0] > alpha[1]) {
+        for (int p = 2; p < 8; p++) {
+            alpha[p] = ((8 - p) * alpha[0] + (p - 1) * alpha[1]) / 7;
+        }
+    } else {
+        for (int p = 2; p < 6; p++) {
+            alpha[p] = ((6 - p) * alpha[0] + (p - 1) * alpha[1]) / 5;
+        }
+        alpha[6] = 0;
+        alpha[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= (uint64_t)in[2 + i] << (i * 8);
+    }
+    for (int i = 0; i < 16; i++) {
+        texels[i][3] = (unsigned char)alpha[(bits >> (i * 3)) & 7];
+    }
+}
+
+static bool decodeBc7Block(const unsigned char* in, unsigned char (*texels)[4]) {
+    BitReader reader = { in, 0 };
+    if (reader.read(7) != (1 << 6)) {
+        return false;
+    }
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = (int)reader.read(7) << 1;
+        endpoints[1][c] = (int)reader.read(7) << 1;
+    }
+    int p0 = (int)reader.read(1), p1 = (int)reader.read(1);
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] |= p0;
+        endpoints[1][c] |= p1;
+    }
+    for (int i = 0; i < 16; i++) {
+        int weight = bc7Weights[reader.read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++) {
+            texels[i][c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+bool decompressImage(const unsigned char* blocks, int width, int height, BlockFormat format,
+                     std::vector<unsigned char>& rgba) {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t blockBytes = getBlockBytes(format);
+    rgba.assign((size_t)width * height * 4, 0);
+
+    for (int blockY = 0; blockY < blocksY; blockY++) {
+        for (int blockX = 0; blockX < blocksX; blockX++) {
+            const unsigned char* in = blocks + ((size_t)blockY * blocksX + blockX) * blockBytes;
+            unsigned char texels[16][4];
+            if (format == BlockFormat::BC1) {
+                decodeColorBlock(in, true, texels);
+            } else if (format == BlockFormat::BC3) {
+                decodeColorBlock(in + 8, false, texels);
+                decodeAlphaBlock(in, texels);
+            } else if (!decodeBc7Block(in, texels)) {
+                return false;
+            }
+
+            for (int y = 0; y < 4 && blockY * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && blockX * 4 + x < width; x++) {
+                    std::memcpy(&rgba[((size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4], texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "softraster/cpu_features.h"
+
+// Block-compressed texture formats, encoded on the CPU for the texture baker.
+// Each 4x4 block of texels becomes a fixed-size block the GPU samples
+// directly, so textures take 4x (BC3, BC7) to 8x (BC1) less memory and
+// bandwidth than RGBA8.
+//
+//   BC1  8 bytes per block: two RGB565 endpoints and 2-bit indices; opaque
+//   BC3  16 bytes: a BC1 colour block plus a BC4 alpha block (8 levels)
+//   BC7  16 bytes: written as mode 6 only, one RGBA endpoint pair at 7 bits
+//        plus a shared low bit each, 4-bit indices. Less exact than a full
+//        BC7 encoder on blocks with several distinct colours, but far better
+//        than BC1/BC3 on smooth gradients, and much faster to search.
+//
+// Endpoints start from the block's principal axis and are refined by least
+// squares; the nearest-palette search runs in SSE4.1 or AVX2 when the CPU has
+// them, and block rows are split across the shared worker pool (see
+// row_bands.h).
+
+enum class BlockFormat { BC1, BC3, BC7 };
+
+struct BlockCompressOptions {
+    int threads = 0;                       // 0 = one per hardware thread
+    SimdLevel maxSimd = SimdLevel::AVX2;   // caps the kernels, for comparisons
+};
+
+// 8 or 16
+size_t getBlockBytes(BlockFormat format);
+
+// Bytes for a width x height image: whole blocks, rounded up
+size_t getCompressedSize(BlockFormat format, int width, int height);
+
+// Encodes a tightly packed RGBA8 image of any size; blocks past the right or
+// bottom edge repeat the last column or row. Blocks are in row order, in the
+// same row order as the source.
+bool compressImage(const unsigned char* rgba, int width, int height, BlockFormat format,
+                   const BlockCompressOptions& options, std::vector<unsigned char>& blocks);
+
+// Decodes blocks back to RGBA8, to measure what compression lost. Handles
+// every BC1 and BC3 block but only BC7 mode 6, which is all compressImage()
+// writes; returns false for other BC7 modes.
+bool decompressImage(const unsigned char* blocks, int width, int height, BlockFormat format,
+                     std::vector<unsigned char>& rgba);
+
+const char* blockFormatName(BlockFormat format);
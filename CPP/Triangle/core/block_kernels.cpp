@@ -0,0 +1,38 @@
+#include "block_kernels.h"
+
+FitIndicesKernel getFitIndicesKernel(SimdLevel level) {
+#ifdef TRIANGLE_X86_KERNELS
+    if (level >= SimdLevel::AVX2) {
+        return fitIndicesAvx2;
+    }
+    if (level >= SimdLevel::SSE41) {
+        return fitIndicesSse41;
+    }
+#else
+    (void)level;
+#endif
+    return fitIndicesScalar;
+}
+
+float fitIndicesScalar(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                       int firstChannel, int channelCount, unsigned char* indices) {
+    float total = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float bestError = 0.0f;
+        int best = 0;
+        for (int p = 0; p < paletteSize; p++) {
+            float error = 0.0f;
+            for (int c = firstChannel; c < firstChannel + channelCount; c++) {
+                float d = texels.channel[c][i] - palette[p][c];
+                error += d * d;
+            }
+            if (p == 0 || error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices[i] = (unsigned char)best;
+        total += bestError;
+    }
+    return total;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "softraster/cpu_features.h"
+
+// The 16 texels of a 4x4 block as floats (0-255), one array per channel
+struct alignas(32) BlockTexels {
+    float channel[4][16];  // R, G, B, A
+};
+
+// Inner loop of the block encoders (block_compress.cpp): picks the nearest
+// palette entry for every texel of a block, comparing channels
+// [firstChannel, firstChannel + channelCount), and returns the summed squared
+// error. Ties go to the lower index.
+using FitIndicesKernel = float (*)(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                                   int firstChannel, int channelCount, unsigned char* indices);
+
+// Kernel for the given level, or for the best level below it that this build has
+FitIndicesKernel getFitIndicesKernel(SimdLevel level);
+
+float fitIndicesScalar(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                       int firstChannel, int channelCount, unsigned char* indices);
+#ifdef TRIANGLE_X86_KERNELS
+// Defined in translation units built with -msse4.1 and -mavx2 -mfma; only
+// call them after checking detectSimdLevel()
+float fitIndicesSse41(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                      int firstChannel, int channelCount, unsigned char* indices);
+float fitIndicesAvx2(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                     int firstChannel, int channelCount, unsigned char* indices);
+#endif
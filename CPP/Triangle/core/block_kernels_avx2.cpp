@@ -0,0 +1,41 @@
+// Built with -mavx2 -mfma; only reached through getFitIndicesKernel()
+#include "block_kernels.h"
+
+#include <immintrin.h>
+
+// Eight texels per register, every palette entry in turn
+float fitIndicesAvx2(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                     int firstChannel, int channelCount, unsigned char* indices) {
+    __m256 total = _mm256_setzero_ps();
+    for (int i = 0; i < 16; i += 8) {
+        __m256 values[4];
+        for (int c = firstChannel; c < firstChannel + channelCount; c++) {
+            values[c] = _mm256_load_ps(&texels.channel[c][i]);
+        }
+
+        __m256 bestError = _mm256_set1_ps(3.4e38f);
+        __m256i best = _mm256_setzero_si256();
+        for (int p = 0; p < paletteSize; p++) {
+            __m256 error = _mm256_setzero_ps();
+            for (int c = firstChannel; c < firstChannel + channelCount; c++) {
+                __m256 d = _mm256_sub_ps(values[c], _mm256_set1_ps(palette[p][c]));
+                error = _mm256_fmadd_ps(d, d, error);
+            }
+            __m256 better = _mm256_cmp_ps(error, bestError, _CMP_LT_OQ);
+            bestError = _mm256_min_ps(error, bestError);
+            best = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best),
+                                                        _mm256_castsi256_ps(_mm256_set1_epi32(p)), better));
+        }
+
+        alignas(32) int bestIndices[8];
+        _mm256_store_si256((__m256i*)bestIndices, best);
+        for (int k = 0; k < 8; k++) {
+            indices[i + k] = (unsigned char)bestIndices[k];
+        }
+        total = _mm256_add_ps(total, bestError);
+    }
+
+    alignas(32) float sums[8];
+    _mm256_store_ps(sums, total);
+    return ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+}
@@ -0,0 +1,40 @@
+// Built with -msse4.1; only reached through getFitIndicesKernel()
+#include "block_kernels.h"
+
+#include <smmintrin.h>
+
+// Four texels per register, every palette entry in turn
+float fitIndicesSse41(const BlockTexels& texels, const float (*palette)[4], int paletteSize,
+                      int firstChannel, int channelCount, unsigned char* indices) {
+    __m128 total = _mm_setzero_ps();
+    for (int i = 0; i < 16; i += 4) {
+        __m128 values[4];
+        for (int c = firstChannel; c < firstChannel + channelCount; c++) {
+            values[c] = _mm_load_ps(&texels.channel[c][i]);
+        }
+
+        __m128 bestError = _mm_set1_ps(3.4e38f);
+        __m128i best = _mm_setzero_si128();
+        for (int p = 0; p < paletteSize; p++) {
+            __m128 error = _mm_setzero_ps();
+            for (int c = firstChannel; c < firstChannel + channelCount; c++) {
+                __m128 d = _mm_sub_ps(values[c], _mm_set1_ps(palette[p][c]));
+                error = _mm_add_ps(error, _mm_mul_ps(d, d));
+            }
+            __m128 better = _mm_cmplt_ps(error, bestError);
+            bestError = _mm_min_ps(error, bestError);
+            best = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(best), _mm_castsi128_ps(_mm_set1_epi32(p)), better));
+        }
+
+        alignas(16) int bestIndices[4];
+        _mm_store_si128((__m128i*)bestIndices, best);
+        for (int k = 0; k < 4; k++) {
+            indices[i + k] = (unsigned char)bestIndices[k];
+        }
+        total = _mm_add_ps(total, bestError);
+    }
+
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
@@ -0,0 +1,182 @@
+#include "demo_app.h"
+
+#include <chrono>
+#include <iostream>
+#include "frame_stats.h"
+#include "texture_manager.h"
+#include "trace.h"
+
+DemoApp::DemoApp(const DemoConfig& config, const RunOptions& options) : config(config), options(options) {}
+
+DemoApp::~DemoApp() {
+    // The derived class has dropped its texture handles. Another app may have
+    // drawn since, and the last user of the shared cache clears it, so this
+    // context has to be current again.
+    context.makeCurrent();
+    if (textureManagerUser) {
+        getTextureManager().releaseContextUser();
+    }
+    frameCapture.destroy();
+    gpuProfiler.destroy();
+    context.destroy();
+
+    // Everything in the derived class, including loader threads, is gone by now
+    if (!options.traceFile.empty()) {
+        stopTrace();
+    }
+}
+
+void DemoApp::addGpuFrame(FrameRecorder& recorder, const GpuFrame& gpuFrame) {
+    recorder.addGpuFrame(gpuFrame);
+    for (const GpuZoneTime& zone : gpuFrame.zones) {
+        traceGpuEvent(zone.name, zone.startNs, (int64_t)(zone.ms * 1.0e6));
+    }
+}
+
+bool DemoApp::init() {
+    auto start = std::chrono::steady_clock::now();
+    if (!options.traceFile.empty()) {
+        startTrace(options.traceFile);
+        setTraceThreadName("main");
+    }
+    TraceZone zone("startup");
+
+    // Create window (or offscreen context in headless mode) and load OpenGL
+    ContextConfig contextConfig;
+    contextConfig.backend = options.headless ? ContextBackend::Headless : ContextBackend::Window;
+    contextConfig.vsync = !options.benchmark;
+    contextConfig.syncOnSwap = options.benchmark;
+    contextConfig.width = config.width;
+    contextConfig.height = config.height;
+    contextConfig.title = config.title;
+    contextConfig.forwardCompat = config.forwardCompat;
+    {
+        TraceZone contextZone("create context");
+        if (!context.create(contextConfig)) {
+            return false;
+        }
+    }
+
+    if (options.gpuProfile) {
+        gpuProfiler.create();
+    }
+    getTextureManager().addContextUser();
+    textureManagerUser = true;
+    getTextureManager().setBudget((size_t)options.textureBudgetMiB << 20);
+
+    // Cached program binaries skip compiling and linking on warm starts
+    programCache.open(options.shaderCache);
+    {
+        TraceZone setupZone("setup");
+        if (!setup()) {
+            return false;
+        }
+    }
+    programCache.printSummary();
+
+    // The initial viewport is the real framebuffer size (it can differ from the window size)
+    if (!options.capturePattern.empty()) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        frameCapture.create(options.capturePattern, viewport[2], viewport[3]);
+    }
+
+    std::cout << "Startup: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+    return true;
+}
+
+bool DemoApp::createProgram(ShaderProgram& program, const char* vertexSource, const char* fragmentSource,
+                            const std::string& prelude) {
+    return program.create(vertexSource, fragmentSource, prelude, &programCache);
+}
+
+void DemoApp::processInput() {
+    if (context.isKeyPressed(GLFW_KEY_ESCAPE)) {
+        context.requestClose();
+    }
+}
+
+void DemoApp::run() {
+    // Another app in the process may have drawn since init()
+    context.makeCurrent();
+    FrameRecorder recorder(config.name, options);
+    clock.reset(options.clock);
+    auto lastTitleUpdate = std::chrono::steady_clock::now();
+
+    while (!context.shouldClose() && !recorder.finished()) {
+        TraceZone frameZone("frame");
+        recorder.beginFrame();
+        gpuProfiler.beginFrame(recorder.currentFrame());
+
+        {
+            TraceZone zone("input");
+            processInput();
+        }
+        recorder.lap(FramePhase::Input);
+
+        {
+            TraceZone zone("update");
+            for (int steps = clock.beginFrame(); steps > 0; steps--) {
+                update((float)clock.getStep());
+            }
+        }
+        recorder.lap(FramePhase::Update);
+
+        {
+            TraceZone zone("render");
+            render();
+        }
+        if (frameCapture.isEnabled()) {
+            if (recorder.currentFrame() % options.captureEvery == 0) {
+                GpuZone zone(gpuProfiler, "capture");
+                frameCapture.capture(recorder.currentFrame());
+            } else {
+                frameCapture.update();
+            }
+        }
+        recorder.lap(FramePhase::Render);
+
+        {
+            TraceZone zone("swap");
+            {
+                GpuZone gpuZone(gpuProfiler, "swap");
+                context.swapBuffers();
+            }
+            context.pollEvents();
+        }
+        recorder.lap(FramePhase::Swap);
+
+        gpuProfiler.endFrame();
+        recorder.endFrame();
+        for (const GpuFrame& gpuFrame : gpuProfiler.takeCompleted()) {
+            addGpuFrame(recorder, gpuFrame);
+        }
+
+        // Live timings in the title bar, twice a second
+        auto now = std::chrono::steady_clock::now();
+        if (!context.isHeadless() && !recorder.getLiveSummary().empty() && now - lastTitleUpdate > std::chrono::milliseconds(500)) {
+            context.setTitle((std::string(config.title) + " | " + recorder.getLiveSummary()).c_str());
+            lastTitleUpdate = now;
+        }
+    }
+
+    // Draining the captures and GPU queries below is not frame time
+    recorder.stop();
+    frameCapture.finish();
+    gpuProfiler.finish();
+    for (const GpuFrame& gpuFrame : gpuProfiler.takeCompleted()) {
+        addGpuFrame(recorder, gpuFrame);
+    }
+    if (gpuProfiler.getDroppedFrames() > 0) {
+        std::cout << "GPU profiler: " << gpuProfiler.getDroppedFrames() << " frames dropped (results not ready in time)" << std::endl;
+    }
+    const TextureCacheStats& textureStats = getTextureManager().getStats();
+    if (textureStats.hits + textureStats.misses > 0) {
+        std::cout << "Texture cache: " << textureStats.hits << " hits, " << textureStats.misses << " misses, "
+                  << textureStats.evictions << " evictions, " << textureStats.residentTextures << " textures ("
+                  << textureStats.residentBytes / 1024 << " KiB of " << (textureStats.budgetBytes >> 20) << " MiB)"
+                  << std::endl;
+    }
+    recorder.report();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include "gl_context.h"
+#include "run_options.h"
+#include "shader_program.h"
+#include "program_cache.h"
+#include "sim_clock.h"
+#include "gpu_profiler.h"
+#include "frame_capture.h"
+
+struct DemoConfig {
+    const char* name = "demo";     // benchmark JSON and summary line
+    const char* title = "OpenGL";  // window title
+    int width = 800;
+    int height = 600;
+    bool forwardCompat = false;
+};
+
+// Base class of the OpenGL demos. It owns the context, the program cache and
+// the frame loop, so timing and other per-frame features live in one place:
+//
+//   class MyDemo : public DemoApp {
+//       bool setup() override;          // shaders, buffers, textures
+//       void update(float dt) override; // one fixed simulation step
+//       void render() override;         // one frame
+//   };
+//
+// Animation belongs in update(), which always advances by the same step;
+// render() blends the last two states by clock.getAlpha() (see SimulationClock).
+// render() wraps its clear and draw calls in GpuZone scopes; they cost nothing
+// unless --gpu-profile is given.
+//
+// GL objects in the derived class should be RAII members (GLBuffer, Mesh,
+// ShaderProgram, ...): they are destroyed before this base class tears down
+// the context.
+//
+// Several apps can live in one process: their contexts share objects (see
+// GLContext), so textures from the TextureManager work in all of them.
+class FrameRecorder;
+
+class DemoApp {
+private:
+    DemoConfig config;
+    FrameCapture frameCapture;
+    bool textureManagerUser = false;
+
+    // Hands GPU results to the recorder and the trace
+    void addGpuFrame(FrameRecorder& recorder, const GpuFrame& gpuFrame);
+
+protected:
+    GLContext context;
+    RunOptions options;
+    ProgramCache programCache;
+    SimulationClock clock;
+    GpuProfiler gpuProfiler;
+
+    // Called once after the context is current
+    virtual bool setup() = 0;
+    // ESC closes the demo; overrides should call this for that
+    virtual void processInput();
+    virtual void update(float /*dt*/) {}
+    virtual void render() = 0;
+
+    // Compiles (or loads from the cache) a program
+    bool createProgram(ShaderProgram& program, const char* vertexSource, const char* fragmentSource,
+                       const std::string& prelude = "");
+
+    int getWidth() const { return config.width; }
+    int getHeight() const { return config.height; }
+
+public:
+    DemoApp(const DemoConfig& config, const RunOptions& options);
+    virtual ~DemoApp();
+
+    DemoApp(const DemoApp&) = delete;
+    DemoApp& operator=(const DemoApp&) = delete;
+
+    // Creates the context and runs setup(); prints the startup time
+    bool init();
+    // Runs frames until the window closes or the requested frame count is reached
+    void run();
+};
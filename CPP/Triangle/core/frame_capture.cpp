@@ -0,0 +1,162 @@
+#include "frame_capture.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include "image_writer.h"
+#include "trace.h"
+
+FrameCapture::FrameCapture() : width(0), height(0), nextSlot(0), captured(0), dropped(0), failed(0) {}
+
+FrameCapture::~FrameCapture() {
+    destroy();
+}
+
+bool FrameCapture::create(const std::string& capturePattern, int captureWidth, int captureHeight, int ringSize) {
+    destroy();
+    pattern = capturePattern;
+    width = captureWidth;
+    height = captureHeight;
+
+    GLsizeiptr size = (GLsizeiptr)width * height * 4;
+    for (int i = 0; i < ringSize; i++) {
+        std::unique_ptr<Slot> slot(new Slot());
+        glGenBuffers(1, &slot->buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot->fence = nullptr;
+        slot->mapped = nullptr;
+        slot->frame = 0;
+        slot->state = SlotState::Free;
+        slots.push_back(std::move(slot));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // One writer keeps files in frame order and leaves the other cores to the demo
+    writer.reset(new ThreadPool(1));
+    return true;
+}
+
+void FrameCapture::destroy() {
+    // Joins the writer first, so nothing still reads a mapping
+    writer.reset();
+    for (auto& slot : slots) {
+        release(*slot);
+        glDeleteBuffers(1, &slot->buffer);
+    }
+    slots.clear();
+    nextSlot = 0;
+}
+
+std::string FrameCapture::pathFor(int frame) const {
+    if (pattern.find('%') == std::string::npos) {
+        return pattern;
+    }
+    char path[1024];
+    std::snprintf(path, sizeof(path), pattern.c_str(), frame);
+    return path;
+}
+
+void FrameCapture::release(Slot& slot) {
+    if (slot.fence) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    if (slot.mapped) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.mapped = nullptr;
+    }
+    slot.state = SlotState::Free;
+}
+
+void FrameCapture::capture(int frame) {
+    if (!isEnabled()) {
+        return;
+    }
+    TraceZone zone("capture frame");
+    update();
+
+    Slot& slot = *slots[nextSlot];
+    if (slot.state != SlotState::Free) {
+        dropped++;
+        return;
+    }
+    nextSlot = (nextSlot + 1) % slots.size();
+
+    // With a pack buffer bound, glReadPixels only queues the copy
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    slot.state = SlotState::Reading;
+    captured++;
+}
+
+void FrameCapture::startWrite(Slot& slot) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    slot.mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)width * height * 4, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!slot.mapped) {
+        std::cerr << "Failed to map the readback of frame " << slot.frame << std::endl;
+        failed++;
+        slot.state = SlotState::Free;
+        return;
+    }
+
+    // GL rows run bottom-up: start at the last row and step backwards
+    slot.state = SlotState::Writing;
+    Slot* target = &slot;
+    std::string path = pathFor(slot.frame);
+    writer->submit([this, target, path] {
+        TraceZone zone("write frame");
+        size_t rowBytes = (size_t)width * 4;
+        const unsigned char* top = (const unsigned char*)target->mapped + rowBytes * (height - 1);
+        if (!writeImage(path, width, height, 4, top, -(ptrdiff_t)rowBytes)) {
+            failed++;
+        }
+        target->state = SlotState::Written;
+    });
+}
+
+void FrameCapture::update() {
+    for (auto& slot : slots) {
+        if (slot->state == SlotState::Reading) {
+            GLenum status = glClientWaitSync(slot->fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                startWrite(*slot);
+            }
+        } else if (slot->state == SlotState::Written) {
+            release(*slot);
+        }
+    }
+}
+
+void FrameCapture::finish() {
+    if (!isEnabled()) {
+        return;
+    }
+    glFlush();
+    bool busy = true;
+    while (busy) {
+        update();
+        busy = false;
+        for (auto& slot : slots) {
+            busy = busy || slot->state != SlotState::Free;
+        }
+        if (busy) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::cout << "Captured " << captured - failed << " frames to " << pattern;
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " dropped while the readback ring was full)";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "thread_pool.h"
+
+// Reads rendered frames back to image files without stalling the frame loop.
+//
+// capture() queues glReadPixels of the current read framebuffer (the back
+// buffer, or the headless FBO) into one of a ring of pixel pack buffers and
+// drops a fence behind it; the call returns as soon as the copy is queued.
+// update() polls the fences without waiting: a finished buffer is mapped and
+// handed to a writer thread, which encodes the image straight from the
+// mapping, and the buffer is unmapped and reused once the file is written.
+// If every buffer is still busy the frame is skipped and counted as dropped
+// rather than waited for.
+//
+// Paths come from a printf-style pattern with the frame number, e.g.
+// "frames/frame_%05d.png"; without a conversion every capture overwrites the
+// same file. The format follows the extension (see writeImage()).
+class FrameCapture {
+private:
+    enum class SlotState { Free, Reading, Writing, Written };
+
+    struct Slot {
+        GLuint buffer;
+        GLsync fence;
+        void* mapped;
+        int frame;
+        std::atomic<SlotState> state;
+    };
+
+    std::string pattern;
+    int width, height;
+    std::vector<std::unique_ptr<Slot>> slots;
+    size_t nextSlot;
+    std::unique_ptr<ThreadPool> writer;
+    int captured;
+    int dropped;
+    std::atomic<int> failed;
+
+    std::string pathFor(int frame) const;
+    void startWrite(Slot& slot);
+    void release(Slot& slot);
+
+public:
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    bool create(const std::string& pattern, int width, int height, int ringSize = 3);
+    void destroy();
+    bool isEnabled() const { return !slots.empty(); }
+
+    // Call after rendering a frame, before swapping buffers
+    void capture(int frame);
+    // Moves finished readbacks to the writer; never waits
+    void update();
+    // Waits until every queued frame is on disk (end of a run)
+    void finish();
+
+    int getCapturedCount() const { return captured; }
+    int getDroppedCount() const { return dropped; }
+};
@@ -0,0 +1,54 @@
+#include "frame_constants.h"
+
+#include <cstring>
+
+const char* const kFrameConstantsGlsl = R"(
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+)";
+
+FrameConstantsBuffer::FrameConstantsBuffer() : buffer(0), current(), uploaded(false) {}
+
+FrameConstantsBuffer::~FrameConstantsBuffer() {
+    destroy();
+}
+
+bool FrameConstantsBuffer::create() {
+    destroy();
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameConstantsBinding, buffer);
+    uploaded = false;
+    return buffer != 0;
+}
+
+void FrameConstantsBuffer::destroy() {
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    uploaded = false;
+}
+
+void FrameConstantsBuffer::update(const FrameConstants& constants) {
+    if (uploaded && std::memcmp(&current, &constants, sizeof(FrameConstants)) == 0) {
+        return;
+    }
+
+    // The block is small enough for drivers to stage the update inline without a stall
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    current = constants;
+    uploaded = true;
+}
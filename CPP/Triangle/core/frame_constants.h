@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Per-frame camera and lighting data shared by every program through one
+// uniform buffer. The struct mirrors the std140 block in kFrameConstantsGlsl:
+// vec3 values are padded to vec4 so both layouts agree without manual offsets.
+struct FrameConstants {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec4 lightPos = glm::vec4(0.0f);     // xyz = world position
+    glm::vec4 lightColor = glm::vec4(0.0f);   // rgb
+    glm::vec4 viewPos = glm::vec4(0.0f);      // xyz = camera position
+};
+
+static_assert(sizeof(FrameConstants) == 176, "FrameConstants must match the std140 block layout");
+
+// Uniform buffer binding point of the FrameConstants block in all programs
+constexpr GLuint kFrameConstantsBinding = 0;
+
+// GLSL declaration of the block, for ShaderProgram::create()'s prelude
+extern const char* const kFrameConstantsGlsl;
+
+// Owns the uniform buffer behind the FrameConstants block. The buffer stays
+// bound to kFrameConstantsBinding, so programs and draws never rebind it;
+// update() costs one glBufferSubData per frame, and nothing if the data has
+// not changed since the last frame.
+class FrameConstantsBuffer {
+private:
+    GLuint buffer;
+    FrameConstants current;
+    bool uploaded;
+
+public:
+    FrameConstantsBuffer();
+    ~FrameConstantsBuffer();
+
+    FrameConstantsBuffer(const FrameConstantsBuffer&) = delete;
+    FrameConstantsBuffer& operator=(const FrameConstantsBuffer&) = delete;
+
+    bool create();
+    void destroy();
+
+    void update(const FrameConstants& constants);
+};
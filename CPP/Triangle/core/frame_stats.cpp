@@ -0,0 +1,279 @@
+#include "frame_stats.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "texture_manager.h"
+#include "trace.h"
+
+// CPU timings kept around for GPU results that are still in flight
+static const size_t maxRecentFrames = 16;
+
+static const char* phaseNames[(int)FramePhase::Count] = { "input", "update", "render", "swap" };
+
+// Upper bounds of the frame time histogram buckets in milliseconds. Fixed edges
+// keep histograms from different builds and machines directly comparable.
+static const double histogramEdgesMs[] = { 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7 };
+
+FrameRecorder::FrameRecorder(const std::string& name, const RunOptions& options)
+    : name(name), options(options), framesStarted(0), phaseMs() {
+    if (options.benchmark) {
+        frameTimes.reserve(options.frames);
+        for (auto& times : phaseTimes) {
+            times.reserve(options.frames);
+        }
+    }
+    if (!options.profileLog.empty()) {
+        profileLog.open(options.profileLog);
+        if (!profileLog) {
+            std::cerr << "Failed to open profile log " << options.profileLog << std::endl;
+        }
+    }
+}
+
+bool FrameRecorder::finished() const {
+    return options.frames > 0 && framesStarted >= options.warmup + options.frames;
+}
+
+void FrameRecorder::beginFrame() {
+    framesStarted++;
+    frameStart = Clock::now();
+    lastLap = frameStart;
+    std::fill(std::begin(phaseMs), std::end(phaseMs), 0.0);
+
+    if (framesStarted == options.warmup + 1) {
+        measureStart = frameStart;
+    }
+}
+
+void FrameRecorder::lap(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    phaseMs[(int)phase] += std::chrono::duration<double, std::milli>(now - lastLap).count();
+    lastLap = now;
+}
+
+void FrameRecorder::endFrame() {
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+    CpuFrame cpuFrame;
+    cpuFrame.frame = framesStarted;
+    cpuFrame.totalMs = totalMs;
+    std::copy(std::begin(phaseMs), std::end(phaseMs), cpuFrame.phaseMs);
+    recentFrames.push_back(cpuFrame);
+    if (recentFrames.size() > maxRecentFrames) {
+        recentFrames.pop_front();
+    }
+
+    if (isWarmupFrame() || !options.benchmark) {
+        return;
+    }
+
+    frameTimes.push_back(totalMs);
+    for (int i = 0; i < (int)FramePhase::Count; i++) {
+        phaseTimes[i].push_back(phaseMs[i]);
+    }
+}
+
+void FrameRecorder::addGpuFrame(const GpuFrame& gpuFrame) {
+    while (!recentFrames.empty() && recentFrames.front().frame < gpuFrame.frame) {
+        recentFrames.pop_front();
+    }
+    const CpuFrame* cpuFrame = nullptr;
+    if (!recentFrames.empty() && recentFrames.front().frame == gpuFrame.frame) {
+        cpuFrame = &recentFrames.front();
+    }
+
+    if (gpuFrame.frame > options.warmup) {
+        for (const auto& zone : gpuFrame.zones) {
+            GpuZoneStats& stats = gpuZones[zone.name];
+            if (options.benchmark) {
+                stats.samples.push_back(zone.ms);
+            }
+            stats.sumMs += zone.ms;
+            stats.count++;
+        }
+    }
+
+    std::ostringstream summary;
+    summary.precision(3);
+    summary << std::fixed;
+    if (cpuFrame) {
+        summary << "CPU " << cpuFrame->totalMs << " ms | ";
+    }
+    summary << "GPU";
+    for (size_t i = 0; i < gpuFrame.zones.size(); i++) {
+        const auto& zone = gpuFrame.zones[i];
+        if (i == 0) {
+            summary << " " << zone.ms << " ms";
+        } else {
+            summary << (i == 1 ? " (" : ", ") << zone.name << " " << zone.ms;
+        }
+    }
+    summary << (gpuFrame.zones.size() > 1 ? ")" : "");
+    lastGpuSummary = summary.str();
+
+    if (profileLog) {
+        profileLog << "{\"frame\": " << gpuFrame.frame;
+        if (cpuFrame) {
+            profileLog << ", \"cpu_ms\": {\"total\": " << cpuFrame->totalMs;
+            for (int i = 0; i < (int)FramePhase::Count; i++) {
+                profileLog << ", \"" << phaseNames[i] << "\": " << cpuFrame->phaseMs[i];
+            }
+            profileLog << "}";
+        }
+        profileLog << ", \"gpu_ms\": {";
+        for (size_t i = 0; i < gpuFrame.zones.size(); i++) {
+            profileLog << (i > 0 ? ", " : "");
+            writeJsonString(profileLog, gpuFrame.zones[i].name);
+            profileLog << ": " << gpuFrame.zones[i].ms;
+        }
+        profileLog << "}}\n";
+    }
+}
+
+// Nearest-rank percentile of an already sorted sample
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+static void writeStats(std::ostream& out, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) {
+        sum += s;
+    }
+    double mean = samples.empty() ? 0.0 : sum / samples.size();
+
+    out << "{\"min\": " << (samples.empty() ? 0.0 : samples.front())
+        << ", \"median\": " << percentile(samples, 50.0)
+        << ", \"mean\": " << mean
+        << ", \"p95\": " << percentile(samples, 95.0)
+        << ", \"p99\": " << percentile(samples, 99.0)
+        << ", \"max\": " << (samples.empty() ? 0.0 : samples.back()) << "}";
+}
+
+void FrameRecorder::writeJson(std::ostream& out, double totalSeconds) const {
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    int frames = recordedFrames();
+
+    out << "{\n";
+    out << "  \"demo\": ";
+    writeJsonString(out, name.c_str());
+    out << ",\n";
+    out << "  \"backend\": \"" << (options.headless ? "headless" : "window") << "\",\n";
+    out << "  \"renderer\": ";
+    writeJsonString(out, renderer ? renderer : "unknown");
+    out << ",\n";
+    out << "  \"clock\": \"" << clockModeName(options.clock) << "\",\n";
+    out << "  \"warmup_frames\": " << options.warmup << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"total_seconds\": " << totalSeconds << ",\n";
+    out << "  \"fps\": " << (totalSeconds > 0.0 ? frames / totalSeconds : 0.0) << ",\n";
+    if (options.instances > 0) {
+        out << "  \"instances\": " << options.instances << ",\n";
+        out << "  \"triangles_per_second\": " << (totalSeconds > 0.0 ? (double)options.instances * frames / totalSeconds : 0.0) << ",\n";
+    }
+
+    out << "  \"frame_ms\": ";
+    writeStats(out, frameTimes);
+    out << ",\n";
+
+    out << "  \"phases_ms\": {\n";
+    for (int i = 0; i < (int)FramePhase::Count; i++) {
+        out << "    \"" << phaseNames[i] << "\": ";
+        writeStats(out, phaseTimes[i]);
+        out << (i + 1 < (int)FramePhase::Count ? ",\n" : "\n");
+    }
+    out << "  },\n";
+
+    // GPU zone times cover the frames whose results were read back
+    if (!gpuZones.empty()) {
+        out << "  \"gpu_ms\": {\n";
+        size_t index = 0;
+        for (const auto& zone : gpuZones) {
+            out << "    ";
+            writeJsonString(out, zone.first.c_str());
+            out << ": ";
+            writeStats(out, zone.second.samples);
+            out << (++index < gpuZones.size() ? ",\n" : "\n");
+        }
+        out << "  },\n";
+    }
+
+    // Shared texture cache, for demos that load through it
+    const TextureCacheStats& textureStats = getTextureManager().getStats();
+    if (textureStats.hits + textureStats.misses > 0) {
+        out << "  \"texture_cache\": {\"hits\": " << textureStats.hits << ", \"misses\": " << textureStats.misses
+            << ", \"evictions\": " << textureStats.evictions << ", \"textures\": " << textureStats.residentTextures
+            << ", \"resident_bytes\": " << textureStats.residentBytes
+            << ", \"budget_bytes\": " << textureStats.budgetBytes << "},\n";
+    }
+
+    // Each bucket counts frames with time <= "le" (and above the previous edge)
+    const int edgeCount = sizeof(histogramEdgesMs) / sizeof(histogramEdgesMs[0]);
+    std::vector<int> buckets(edgeCount + 1, 0);
+    for (double t : frameTimes) {
+        int bucket = (int)(std::lower_bound(histogramEdgesMs, histogramEdgesMs + edgeCount, t) - histogramEdgesMs);
+        buckets[bucket]++;
+    }
+    out << "  \"histogram_ms\": [";
+    for (int i = 0; i <= edgeCount; i++) {
+        out << "{\"le\": ";
+        if (i < edgeCount) {
+            out << histogramEdgesMs[i];
+        } else {
+            out << "null";
+        }
+        out << ", \"count\": " << buckets[i] << "}" << (i < edgeCount ? ", " : "");
+    }
+    out << "]\n";
+    out << "}\n";
+}
+
+void FrameRecorder::stop() {
+    // Wait for the GPU so the measurement covers every submitted frame
+    glFinish();
+    measureEnd = Clock::now();
+}
+
+void FrameRecorder::report() const {
+    int frames = framesStarted - options.warmup;
+    if (frames <= 0) {
+        return;
+    }
+    double totalSeconds = std::chrono::duration<double>(measureEnd - measureStart).count();
+
+    if (!options.benchmark) {
+        std::cout << name << ": " << frames << " frames in " << totalSeconds << " s ("
+                  << frames / totalSeconds << " FPS, " << totalSeconds * 1000.0 / frames << " ms/frame)" << std::endl;
+        if (!gpuZones.empty()) {
+            std::cout << "GPU mean:";
+            for (const auto& zone : gpuZones) {
+                std::cout << " " << zone.first << " " << zone.second.sumMs / zone.second.count << " ms";
+            }
+            std::cout << std::endl;
+        }
+        return;
+    }
+
+    if (options.benchmarkOutput == "-") {
+        writeJson(std::cout, totalSeconds);
+        return;
+    }
+
+    std::string path = options.benchmarkOutput.empty() ? name + "_benchmark.json" : options.benchmarkOutput;
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to write benchmark results to " << path << std::endl;
+        return;
+    }
+    writeJson(file, totalSeconds);
+    std::cout << "Benchmark results written to " << path << std::endl;
+}
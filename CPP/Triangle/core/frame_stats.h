@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "run_options.h"
+#include "gpu_profiler.h"
+
+// CPU-side phases of one iteration of a demo's run() loop
+enum class FramePhase {
+    Input,
+    Update,
+    Render,
+    Swap,
+    Count
+};
+
+// Times every frame of a run() loop and decides when a fixed-length run is over.
+//
+//   recorder.beginFrame();
+//   processInput();               recorder.lap(FramePhase::Input);
+//   update(step) per clock step;  recorder.lap(FramePhase::Update);
+//   render();                     recorder.lap(FramePhase::Render);
+//   swapBuffers(); pollEvents();  recorder.lap(FramePhase::Swap);
+//   recorder.endFrame();
+//   ...
+//   recorder.stop();              // before draining captures or GPU queries
+//   recorder.report();
+//
+// Warmup frames are rendered but not recorded. In benchmark mode report()
+// writes frame time percentiles, per-phase timings and a histogram as JSON;
+// otherwise it prints a one-line throughput summary.
+//
+// GPU zone times arrive a few frames late (see GpuProfiler) through
+// addGpuFrame(); they are matched with the CPU timings of the same frame,
+// added to the statistics and, with --profile-log, written as one JSON line
+// per frame.
+class FrameRecorder {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string name;
+    RunOptions options;
+    int framesStarted;
+    Clock::time_point frameStart;
+    Clock::time_point lastLap;
+    Clock::time_point measureStart;
+    Clock::time_point measureEnd;
+    double phaseMs[(int)FramePhase::Count];
+
+    // Per recorded frame, in milliseconds
+    std::vector<double> frameTimes;
+    std::vector<double> phaseTimes[(int)FramePhase::Count];
+
+    // CPU timings of the last few frames, until their GPU times arrive
+    struct CpuFrame {
+        int frame;
+        double totalMs;
+        double phaseMs[(int)FramePhase::Count];
+    };
+    std::deque<CpuFrame> recentFrames;
+
+    // Per GPU zone: samples (benchmark mode only), running sum and count
+    struct GpuZoneStats {
+        std::vector<double> samples;
+        double sumMs = 0.0;
+        int count = 0;
+    };
+    std::map<std::string, GpuZoneStats> gpuZones;
+    std::string lastGpuSummary;
+    std::ofstream profileLog;
+
+    bool isWarmupFrame() const { return framesStarted <= options.warmup; }
+    void writeJson(std::ostream& out, double totalSeconds) const;
+
+public:
+    FrameRecorder(const std::string& name, const RunOptions& options);
+
+    // True once the requested number of frames (plus warmup) has been rendered
+    bool finished() const;
+
+    void beginFrame();
+    void lap(FramePhase phase);
+    void endFrame();
+
+    // GPU zone times of an earlier frame
+    void addGpuFrame(const GpuFrame& gpuFrame);
+
+    // 1-based index of the frame in progress
+    int currentFrame() const { return framesStarted; }
+    int recordedFrames() const { return (int)frameTimes.size(); }
+
+    // "CPU x ms | GPU y ms (zone z, ...)" for the latest frame with GPU times
+    const std::string& getLiveSummary() const { return lastGpuSummary; }
+
+    // Ends the measured time: waits for the GPU to finish the submitted frames
+    // and stamps the end. Call right after the loop, before any teardown work
+    // (e.g. draining frame captures) that should not count as frame time.
+    void stop();
+
+    // Call after stop(), while the GL context is still current
+    void report() const;
+};
@@ -0,0 +1,340 @@
+#include "gl_context.h"
+#include "gl_extensions.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+#ifdef TRIANGLE_HAVE_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// Every context of a backend joins one share group, so textures and buffers
+// (e.g. the texture manager's cache) are valid in all of them. GLFW and the
+// EGL display are process-wide: the first context initializes them and the
+// last one to go terminates them.
+static std::vector<GLFWwindow*> liveWindows;
+static int glfwUsers = 0;
+#ifdef TRIANGLE_HAVE_EGL
+static std::vector<EGLContext> liveEglContexts;
+static int eglDisplayUsers = 0;
+#endif
+
+GLContext::GLContext()
+    : backend(ContextBackend::Window), window(nullptr), width(0), height(0),
+      closeRequested(false), glfwInitialized(false), syncOnSwap(false),
+      eglDisplay(nullptr), eglSurface(nullptr), eglContext(nullptr),
+      framebuffer(0), colorRenderbuffer(0), depthRenderbuffer(0) {}
+
+GLContext::~GLContext() {
+    destroy();
+}
+
+bool GLContext::create(const ContextConfig& config) {
+    backend = config.backend;
+    width = config.width;
+    height = config.height;
+    closeRequested = false;
+    syncOnSwap = config.syncOnSwap;
+
+    if (backend == ContextBackend::Headless) {
+        return createHeadlessContext(config);
+    }
+    return createWindowContext(config);
+}
+
+bool GLContext::createWindowContext(const ContextConfig& config) {
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return false;
+    }
+    glfwInitialized = true;
+    glfwUsers++;
+
+    // Configure GLFW for OpenGL 3.3 Core Profile
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (config.forwardCompat) {
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    }
+
+    // Create window, sharing objects with the windows already open
+    GLFWwindow* share = liveWindows.empty() ? nullptr : liveWindows.front();
+    window = glfwCreateWindow(width, height, config.title, nullptr, share);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        return false;
+    }
+    liveWindows.push_back(window);
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    if (!config.vsync) {
+        glfwSwapInterval(0);
+    }
+
+    // Load OpenGL function pointers
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    return true;
+}
+
+#ifdef TRIANGLE_HAVE_EGL
+static bool hasEglExtension(const char* extensions, const char* name) {
+    if (!extensions) {
+        return false;
+    }
+    size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static EGLDisplay openHeadlessDisplay() {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay) {
+        // Mesa: no window system at all, works with llvmpipe on GPU-less machines
+        if (hasEglExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+
+        // Vendor drivers (e.g. NVIDIA) expose their GPUs as EGL devices instead
+        if (hasEglExtension(clientExtensions, "EGL_EXT_platform_device")) {
+            auto queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+            EGLDeviceEXT device;
+            EGLint deviceCount = 0;
+            if (queryDevices && queryDevices(1, &device, &deviceCount) && deviceCount > 0) {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+                if (display != EGL_NO_DISPLAY) {
+                    return display;
+                }
+            }
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+bool GLContext::createHeadlessContext(const ContextConfig& config) {
+#ifdef TRIANGLE_HAVE_EGL
+    EGLDisplay display = openHeadlessDisplay();
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+    eglDisplay = display;
+    eglDisplayUsers++;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig eglConfig;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &eglConfig, 1, &configCount) || configCount == 0) {
+        std::cerr << "Failed to find an EGL config for desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    // Same version and profile as the windowed path
+    EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, config.forwardCompat ? EGL_TRUE : EGL_FALSE,
+        EGL_NONE
+    };
+    // The display is the same for every headless context, so they can all share
+    EGLContext share = liveEglContexts.empty() ? EGL_NO_CONTEXT : liveEglContexts.front();
+    EGLContext context = eglCreateContext(display, eglConfig, share, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create EGL context (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    eglContext = context;
+    liveEglContexts.push_back(context);
+
+    // Without EGL_KHR_surfaceless_context a tiny pbuffer is needed to make the context current
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!hasEglExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, eglConfig, pbufferAttributes);
+        if (surface == EGL_NO_SURFACE) {
+            std::cerr << "Failed to create EGL pbuffer surface" << std::endl;
+            return false;
+        }
+        eglSurface = surface;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        std::cerr << "Failed to make EGL context current" << std::endl;
+        return false;
+    }
+
+    // Load OpenGL function pointers
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)eglGetProcAddress);
+
+    if (!createOffscreenFramebuffer()) {
+        return false;
+    }
+
+    std::cout << "Headless context: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+    return true;
+#else
+    (void)config;
+    std::cerr << "Headless mode is not available: built without EGL support" << std::endl;
+    return false;
+#endif
+}
+
+bool GLContext::createOffscreenFramebuffer() {
+    glGenRenderbuffers(1, &colorRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return false;
+    }
+
+    // The FBO stays bound for the lifetime of the context and stands in for the default framebuffer
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void GLContext::destroy() {
+#ifdef TRIANGLE_HAVE_EGL
+    if (eglDisplay) {
+        if (eglContext) {
+            makeCurrent();
+            if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+            if (colorRenderbuffer) glDeleteRenderbuffers(1, &colorRenderbuffer);
+            if (depthRenderbuffer) glDeleteRenderbuffers(1, &depthRenderbuffer);
+            eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(eglDisplay, eglContext);
+            liveEglContexts.erase(std::find(liveEglContexts.begin(), liveEglContexts.end(), eglContext));
+        }
+        if (eglSurface) eglDestroySurface(eglDisplay, eglSurface);
+        // Terminating would destroy the other renderers' contexts too
+        if (--eglDisplayUsers == 0) {
+            eglTerminate(eglDisplay);
+        }
+    }
+#endif
+    eglDisplay = nullptr;
+    eglSurface = nullptr;
+    eglContext = nullptr;
+    framebuffer = 0;
+    colorRenderbuffer = 0;
+    depthRenderbuffer = 0;
+
+    if (window) {
+        glfwDestroyWindow(window);
+        liveWindows.erase(std::find(liveWindows.begin(), liveWindows.end(), window));
+    }
+    if (glfwInitialized) {
+        if (--glfwUsers == 0) {
+            glfwTerminate();
+        }
+        glfwInitialized = false;
+    }
+    window = nullptr;
+}
+
+void GLContext::makeCurrent() {
+    if (window) {
+        glfwMakeContextCurrent(window);
+    }
+#ifdef TRIANGLE_HAVE_EGL
+    if (eglContext) {
+        eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext);
+    }
+#endif
+}
+
+bool GLContext::shouldClose() const {
+    if (closeRequested) {
+        return true;
+    }
+    return window && glfwWindowShouldClose(window);
+}
+
+void GLContext::requestClose() {
+    closeRequested = true;
+    if (window) {
+        glfwSetWindowShouldClose(window, true);
+    }
+}
+
+void GLContext::swapBuffers() {
+    if (window) {
+        glfwSwapBuffers(window);
+    } else if (syncOnSwap) {
+        glFinish();
+    } else {
+        // Nothing to present; just make sure the frame's commands are submitted
+        glFlush();
+    }
+}
+
+void GLContext::pollEvents() {
+    if (window) {
+        glfwPollEvents();
+    }
+}
+
+bool GLContext::isKeyPressed(int key) const {
+    return window && glfwGetKey(window, key) == GLFW_PRESS;
+}
+
+void GLContext::setTitle(const char* title) {
+    if (window) {
+        glfwSetWindowTitle(window, title);
+    }
+}
+
+void GLContext::framebufferSizeCallback(GLFWwindow* /*window*/, int width, int height) {
+    glViewport(0, 0, width, height);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Where the OpenGL context comes from
+enum class ContextBackend {
+    Window,     // Visible GLFW window, renders to the default framebuffer
+    Headless    // Surfaceless EGL context (e.g. Mesa llvmpipe), renders to an FBO
+};
+
+struct ContextConfig {
+    ContextBackend backend = ContextBackend::Window;
+    int width = 800;
+    int height = 600;
+    const char* title = "OpenGL";
+    bool forwardCompat = false;
+    bool vsync = true;
+    // Headless only: wait for the GPU in swapBuffers() so frame times include GPU work
+    bool syncOnSwap = false;
+};
+
+// Owns the OpenGL context of a demo. In window mode this is a plain GLFW
+// window; in headless mode it is an EGL context without any display server,
+// and all rendering goes into an offscreen framebuffer of the configured size.
+//
+// All contexts of one backend in a process share objects, so several
+// renderers can use the same textures and buffers; each makes its own context
+// current before drawing. Window and headless contexts do not share.
+class GLContext {
+private:
+    ContextBackend backend;
+    GLFWwindow* window;
+    int width, height;
+    bool closeRequested;
+    bool glfwInitialized;
+    bool syncOnSwap;
+
+    // Headless state (EGL handles are kept opaque so callers don't need EGL headers)
+    void* eglDisplay;
+    void* eglSurface;
+    void* eglContext;
+    GLuint framebuffer;
+    GLuint colorRenderbuffer;
+    GLuint depthRenderbuffer;
+
+    bool createWindowContext(const ContextConfig& config);
+    bool createHeadlessContext(const ContextConfig& config);
+    bool createOffscreenFramebuffer();
+
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+public:
+    GLContext();
+    ~GLContext();
+
+    GLContext(const GLContext&) = delete;
+    GLContext& operator=(const GLContext&) = delete;
+
+    bool create(const ContextConfig& config);
+    void destroy();
+
+    // Needed only when the process has more than one context
+    void makeCurrent();
+
+    bool shouldClose() const;
+    void requestClose();
+    void swapBuffers();
+    void pollEvents();
+
+    // Always false in headless mode
+    bool isKeyPressed(int key) const;
+    // No-op in headless mode
+    void setTitle(const char* title);
+
+    bool isHeadless() const { return backend == ContextBackend::Headless; }
+    GLFWwindow* getWindow() const { return window; }
+    GLuint getFramebuffer() const { return framebuffer; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+};
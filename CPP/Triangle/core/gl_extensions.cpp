@@ -0,0 +1,53 @@
+#include "gl_extensions.h"
+
+#include <cstring>
+
+static GLExtensions extensions;
+
+bool hasGLVersionOrExtension(int major, int minor, const char* extension) {
+    GLint contextMajor = 0, contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    if (contextMajor > major || (contextMajor == major && contextMinor >= minor)) {
+        return true;
+    }
+
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (name && std::strcmp(name, extension) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load) {
+    extensions = GLExtensions();
+
+    if (hasGLVersionOrExtension(4, 1, "GL_ARB_get_program_binary")) {
+        extensions.getProgramBinary = (PFNGLGETPROGRAMBINARYPROC_EXT)load("glGetProgramBinary");
+        extensions.programBinaryLoad = (PFNGLPROGRAMBINARYPROC_EXT)load("glProgramBinary");
+        extensions.programParameteri = (PFNGLPROGRAMPARAMETERIPROC_EXT)load("glProgramParameteri");
+
+        // Zero formats means the driver accepts the calls but can never save a binary
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        extensions.programBinary = extensions.getProgramBinary && extensions.programBinaryLoad &&
+                                   extensions.programParameteri && formatCount > 0;
+    }
+
+    // S3TC was never made core; the flag is checked by extension name only
+    extensions.textureCompressionS3tc = hasGLVersionOrExtension(99, 0, "GL_EXT_texture_compression_s3tc");
+    extensions.textureCompressionBptc = hasGLVersionOrExtension(4, 2, "GL_ARB_texture_compression_bptc");
+
+    if (hasGLVersionOrExtension(4, 4, "GL_ARB_buffer_storage")) {
+        extensions.allocateBufferStorage = (PFNGLBUFFERSTORAGEPROC_EXT)load("glBufferStorage");
+        extensions.bufferStorage = extensions.allocateBufferStorage != nullptr;
+    }
+}
+
+const GLExtensions& getGLExtensions() {
+    return extensions;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Entry points newer than the OpenGL 3.3 core profile GLAD was generated for.
+// GLContext loads them right after GLAD; a null pointer (or a false flag)
+// means the driver does not have the feature and callers take the 3.3 path.
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// EXT_texture_compression_s3tc (+ EXT_texture_sRGB) and GL 4.2 / ARB_texture_compression_bptc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC_EXT)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC_EXT)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC_EXT)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_EXT)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+struct GLExtensions {
+    // Program binaries are supported and the driver can produce at least one format
+    bool programBinary = false;
+    PFNGLGETPROGRAMBINARYPROC_EXT getProgramBinary = nullptr;
+    PFNGLPROGRAMBINARYPROC_EXT programBinaryLoad = nullptr;
+    PFNGLPROGRAMPARAMETERIPROC_EXT programParameteri = nullptr;
+
+    // Block-compressed texture formats: BC1/BC3 (S3TC, DXT1/DXT5) and BC7 (BPTC).
+    // Only glCompressedTexImage2D is needed, which is core since GL 1.3.
+    bool textureCompressionS3tc = false;
+    bool textureCompressionBptc = false;
+
+    // Immutable buffer storage, which can stay mapped while the GPU reads it
+    // (persistent mapping)
+    bool bufferStorage = false;
+    PFNGLBUFFERSTORAGEPROC_EXT allocateBufferStorage = nullptr;
+};
+
+// Resolves the entry points for the current context with the same loader GLAD used
+void loadGLExtensions(GLADloadproc load);
+
+const GLExtensions& getGLExtensions();
+
+// True for GL_VERSION >= major.minor or when the named extension is listed
+bool hasGLVersionOrExtension(int major, int minor, const char* extension);
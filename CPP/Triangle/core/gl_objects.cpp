@@ -0,0 +1,82 @@
+#include "gl_objects.h"
+
+#include <cstddef>
+
+GLuint GLBufferTraits::create() {
+    GLuint name = 0;
+    glGenBuffers(1, &name);
+    return name;
+}
+
+void GLBufferTraits::destroy(GLuint name) {
+    glDeleteBuffers(1, &name);
+}
+
+GLuint GLVertexArrayTraits::create() {
+    GLuint name = 0;
+    glGenVertexArrays(1, &name);
+    return name;
+}
+
+void GLVertexArrayTraits::destroy(GLuint name) {
+    glDeleteVertexArrays(1, &name);
+}
+
+GLuint GLTextureTraits::create() {
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    return name;
+}
+
+void GLTextureTraits::destroy(GLuint name) {
+    glDeleteTextures(1, &name);
+}
+
+Mesh::Mesh() : vertexCount(0) {}
+
+bool Mesh::create(const float* vertices, GLsizei count, std::initializer_list<int> attributeSizes) {
+    destroy();
+
+    int stride = 0;
+    for (int size : attributeSizes) {
+        stride += size;
+    }
+    if (!vertexArray.create() || !vertexBuffer.create()) {
+        destroy();
+        return false;
+    }
+    vertexCount = count;
+
+    glBindVertexArray(vertexArray.get());
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)count * stride * sizeof(float), vertices, GL_STATIC_DRAW);
+
+    GLuint location = 0;
+    size_t offset = 0;
+    for (int size : attributeSizes) {
+        glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float)));
+        glEnableVertexAttribArray(location);
+        location++;
+        offset += size;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void Mesh::destroy() {
+    vertexArray.destroy();
+    vertexBuffer.destroy();
+    vertexCount = 0;
+}
+
+void Mesh::draw(GLsizei instanceCount) const {
+    glBindVertexArray(vertexArray.get());
+    if (instanceCount > 0) {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <initializer_list>
+#include <utility>
+#include <glad/glad.h>
+
+// Owning handles for GL object names. Each deletes its object when destroyed
+// (so the context must outlive it) and can be moved but not copied. Names
+// created elsewhere, e.g. textures from AsyncTextureLoader, are taken over
+// with reset().
+template <typename Traits>
+class GLObject {
+private:
+    GLuint name;
+
+public:
+    GLObject() : name(0) {}
+    ~GLObject() { destroy(); }
+
+    GLObject(const GLObject&) = delete;
+    GLObject& operator=(const GLObject&) = delete;
+
+    GLObject(GLObject&& other) noexcept : name(other.release()) {}
+    GLObject& operator=(GLObject&& other) noexcept {
+        reset(other.release());
+        return *this;
+    }
+
+    bool create() {
+        destroy();
+        name = Traits::create();
+        return name != 0;
+    }
+
+    void destroy() {
+        if (name) {
+            Traits::destroy(name);
+            name = 0;
+        }
+    }
+
+    // Deletes the current object and takes ownership of another name
+    void reset(GLuint newName) {
+        if (newName != name) {
+            destroy();
+            name = newName;
+        }
+    }
+
+    // Gives up ownership without deleting
+    GLuint release() { return std::exchange(name, 0); }
+
+    GLuint get() const { return name; }
+    explicit operator bool() const { return name != 0; }
+};
+
+struct GLBufferTraits {
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+struct GLVertexArrayTraits {
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+struct GLTextureTraits {
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+using GLBuffer = GLObject<GLBufferTraits>;
+using GLVertexArray = GLObject<GLVertexArrayTraits>;
+using GLTexture = GLObject<GLTextureTraits>;
+
+// Interleaved float vertices in one VBO, with attribute i at location i.
+//
+//   mesh.create(vertices, count, { 3, 2 });   // vec3 position, vec2 texCoord
+//   mesh.draw();
+class Mesh {
+private:
+    GLVertexArray vertexArray;
+    GLBuffer vertexBuffer;
+    GLsizei vertexCount;
+
+public:
+    Mesh();
+
+    // attributeSizes: components per attribute, in location order
+    bool create(const float* vertices, GLsizei vertexCount, std::initializer_list<int> attributeSizes);
+    void destroy();
+
+    // instanceCount > 0 draws instanced (see InstanceBuffer)
+    void draw(GLsizei instanceCount = 0) const;
+
+    GLuint getVertexArray() const { return vertexArray.get(); }
+    GLsizei getVertexCount() const { return vertexCount; }
+};
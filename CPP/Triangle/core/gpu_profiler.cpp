@@ -0,0 +1,135 @@
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include "trace.h"
+
+GpuProfiler::GpuProfiler() : current(nullptr), frameZone(-1), maxZones(0), droppedFrames(0), clockOffsetNs(0) {}
+
+GpuProfiler::~GpuProfiler() {
+    destroy();
+}
+
+bool GpuProfiler::create(int frameLatency, int maxZonesPerFrame) {
+    destroy();
+
+    // Timer queries are core since GL 3.3, but the counter may still be missing
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    if (bits == 0) {
+        std::cerr << "GPU profiling unavailable: the driver has no timestamp queries" << std::endl;
+        return false;
+    }
+
+    // Lines GPU timestamps up with CPU time for traces (drift over a run is ignored)
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    clockOffsetNs = traceNow() - (int64_t)gpuNow;
+
+    maxZones = maxZonesPerFrame;
+    slots.resize(std::max(frameLatency, 2));
+    for (Slot& slot : slots) {
+        slot.queries.resize(maxZones * 2);
+        glGenQueries((GLsizei)slot.queries.size(), slot.queries.data());
+        slot.zones.reserve(maxZones);
+        slot.frame = 0;
+        slot.pending = false;
+    }
+    return true;
+}
+
+void GpuProfiler::destroy() {
+    for (Slot& slot : slots) {
+        glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+    }
+    slots.clear();
+    completed.clear();
+    current = nullptr;
+    frameZone = -1;
+    droppedFrames = 0;
+}
+
+void GpuProfiler::beginFrame(int frame) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    current = &slots[frame % slots.size()];
+    if (current->pending) {
+        collect(*current, false);
+    }
+    current->zones.clear();
+    current->frame = frame;
+    frameZone = beginZone("frame");
+}
+
+void GpuProfiler::endFrame() {
+    if (!current) {
+        return;
+    }
+    endZone(frameZone);
+    current->pending = true;
+    current = nullptr;
+}
+
+int GpuProfiler::beginZone(const char* name) {
+    if (!current || (int)current->zones.size() >= maxZones) {
+        return -1;
+    }
+    int zone = (int)current->zones.size();
+    current->zones.push_back({ name, false });
+    glQueryCounter(current->queries[zone * 2], GL_TIMESTAMP);
+    return zone;
+}
+
+void GpuProfiler::endZone(int zone) {
+    if (!current || zone < 0) {
+        return;
+    }
+    glQueryCounter(current->queries[zone * 2 + 1], GL_TIMESTAMP);
+    current->zones[zone].ended = true;
+}
+
+void GpuProfiler::collect(Slot& slot, bool wait) {
+    slot.pending = false;
+
+    // Queries complete in submission order: the frame zone's end comes last
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available && !wait) {
+        droppedFrames++;
+        return;
+    }
+
+    GpuFrame result;
+    result.frame = slot.frame;
+    for (size_t i = 0; i < slot.zones.size(); i++) {
+        if (!slot.zones[i].ended) {
+            continue;
+        }
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        result.zones.push_back({ slot.zones[i].name, (int64_t)begin + clockOffsetNs, end > begin ? (end - begin) / 1.0e6 : 0.0 });
+    }
+    completed.push_back(result);
+}
+
+void GpuProfiler::finish() {
+    std::vector<Slot*> pending;
+    for (Slot& slot : slots) {
+        if (slot.pending) {
+            pending.push_back(&slot);
+        }
+    }
+    std::sort(pending.begin(), pending.end(), [](const Slot* a, const Slot* b) { return a->frame < b->frame; });
+    for (Slot* slot : pending) {
+        collect(*slot, true);
+    }
+}
+
+std::vector<GpuFrame> GpuProfiler::takeCompleted() {
+    std::vector<GpuFrame> result;
+    result.swap(completed);
+    return result;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+struct GpuZoneTime {
+    const char* name;
+    int64_t startNs;   // on the traceNow() clock
+    double ms;
+};
+
+// GPU time of the zones of one frame
+struct GpuFrame {
+    int frame;
+    std::vector<GpuZoneTime> zones;
+};
+
+// Measures GPU time per named zone with GL_TIMESTAMP queries.
+//
+// Each zone is a pair of glQueryCounter timestamps, so zones may nest and
+// overlap (GL_TIME_ELAPSED queries cannot). Query objects come from a ring of
+// frameLatency per-frame slots: a slot's results are read back only when it
+// comes round again, by which time the GPU has normally finished it, so the
+// render loop never waits on a query. Slots that are still not ready are
+// dropped rather than waited for.
+//
+//   profiler.beginFrame(frame);
+//   { GpuZone zone(profiler, "draw"); glDrawArrays(...); }
+//   profiler.endFrame();
+//   for (const GpuFrame& done : profiler.takeCompleted()) { ... }
+//
+// beginFrame() opens a "frame" zone spanning everything up to endFrame().
+class GpuProfiler {
+private:
+    struct Zone {
+        const char* name;
+        bool ended;
+    };
+
+    struct Slot {
+        std::vector<GLuint> queries;   // begin/end timestamp pair per zone
+        std::vector<Zone> zones;
+        int frame;
+        bool pending;
+    };
+
+    std::vector<Slot> slots;
+    Slot* current;
+    int frameZone;
+    int maxZones;
+    int droppedFrames;
+    // traceNow() minus GPU timestamp, sampled once at create()
+    int64_t clockOffsetNs;
+    std::vector<GpuFrame> completed;
+
+    void collect(Slot& slot, bool wait);
+
+public:
+    GpuProfiler();
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // False (and disabled) if the driver has no timestamp queries
+    bool create(int frameLatency = 4, int maxZonesPerFrame = 32);
+    void destroy();
+    bool isEnabled() const { return !slots.empty(); }
+
+    void beginFrame(int frame);
+    void endFrame();
+
+    // -1 when disabled or out of zones; endZone(-1) does nothing
+    int beginZone(const char* name);
+    void endZone(int zone);
+
+    // Waits for every frame still in flight (e.g. at the end of a run)
+    void finish();
+
+    // Frames whose results arrived since the last call, oldest first
+    std::vector<GpuFrame> takeCompleted();
+
+    int getDroppedFrames() const { return droppedFrames; }
+};
+
+// Times the enclosing scope on the GPU
+class GpuZone {
+private:
+    GpuProfiler& profiler;
+    int zone;
+
+public:
+    GpuZone(GpuProfiler& profiler, const char* name) : profiler(profiler), zone(profiler.beginZone(name)) {}
+    ~GpuZone() { profiler.endZone(zone); }
+
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+};
@@ -0,0 +1,37 @@
+#include "image_reader.h"
+
+#include <climits>
+#include "mapped_file.h"
+#include "png_decoder.h"
+#include "stb_image.h"
+
+unsigned char* loadImageFile(const std::string& path, int& width, int& height, int& channels, int desiredChannels,
+                             bool flipVertically, std::string& error) {
+    // The decoder reads the compressed data once, front to back
+    std::shared_ptr<const MappedFile> file = openSharedMappedFile(path, MapAccess::Sequential);
+    if (!file) {
+        error = "cannot map file";
+        return nullptr;
+    }
+    if (file->size() > (size_t)INT_MAX) {
+        error = "file too large";
+        return nullptr;
+    }
+
+    PngDecodeOptions options;
+    options.flipVertically = flipVertically;
+    unsigned char* pixels = decodePng(file->data(), file->size(), width, height, channels, desiredChannels, options);
+    if (pixels) {
+        return pixels;
+    }
+
+    // The flip flag is per thread, so concurrent loads cannot race on it
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+    pixels = stbi_load_from_memory(file->data(), (int)file->size(), &width, &height, &channels,
+                                                  desiredChannels);
+    if (!pixels) {
+        const char* reason = stbi_failure_reason();
+        error = reason ? reason : "unknown error";
+    }
+    return pixels;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// Decodes an image file read through the shared mapping cache (see
+// openSharedMappedFile()) rather than through stdio. PNGs go through
+// decodePng(), which overlaps inflate and unfiltering on large images; other
+// formats, and PNGs it does not handle, through stbi_load_from_memory. Same
+// results as stbi_load: free the pixels with stbi_image_free(). On failure
+// returns null and sets `error`.
+unsigned char* loadImageFile(const std::string& path, int& width, int& height, int& channels, int desiredChannels,
+                             bool flipVertically, std::string& error);
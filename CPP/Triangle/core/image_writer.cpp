@@ -0,0 +1,308 @@
+#include "image_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+struct CrcTable {
+    uint32_t entries[256];
+
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    // Writer threads may get here at the same time; static init is thread-safe
+    static const CrcTable table;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t adler32(const unsigned char* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size;) {
+        // 5552 bytes is the longest run before the sums can overflow
+        size_t end = std::min(size, i + 5552);
+        for (; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+namespace {
+
+// LSB-first bit packing, as deflate requires
+class BitWriter {
+private:
+    std::vector<unsigned char>& out;
+    uint32_t buffer;
+    int count;
+
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), buffer(0), count(0) {}
+
+    void write(uint32_t bits, int length) {
+        buffer |= bits << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back((unsigned char)buffer);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are defined MSB-first
+    void writeCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        }
+        write(reversed, length);
+    }
+
+    void flush() {
+        if (count > 0) {
+            out.push_back((unsigned char)buffer);
+        }
+        buffer = 0;
+        count = 0;
+    }
+};
+
+const int kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                              67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const int kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const int kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const int kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Fixed literal/length code (RFC 1951, 3.2.6)
+void writeLiteralLength(BitWriter& bits, int symbol) {
+    if (symbol < 144) {
+        bits.writeCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        bits.writeCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        bits.writeCode(symbol - 256, 7);
+    } else {
+        bits.writeCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+void writeMatch(BitWriter& bits, int length, int distance) {
+    int code = 28;
+    while (kLengthBase[code] > length) {
+        code--;
+    }
+    writeLiteralLength(bits, 257 + code);
+    bits.write(length - kLengthBase[code], kLengthExtra[code]);
+
+    int distanceCode = 29;
+    while (kDistanceBase[distanceCode] > distance) {
+        distanceCode--;
+    }
+    bits.writeCode(distanceCode, 5);
+    bits.write(distance - kDistanceBase[distanceCode], kDistanceExtra[distanceCode]);
+}
+
+// zlib stream of one fixed-Huffman block. Matches come from a hash of the
+// next three bytes, keeping only the latest position per hash: far from
+// optimal, but rendered frames are mostly long runs that this finds.
+std::vector<unsigned char> zlibCompress(const std::vector<unsigned char>& data) {
+    const int kWindow = 32768;
+    const int kMaxMatch = 258;
+    const int kHashBits = 15;
+
+    std::vector<unsigned char> out = { 0x78, 0x01 };
+    BitWriter bits(out);
+    bits.write(1, 1);   // final block
+    bits.write(1, 2);   // fixed Huffman codes
+
+    std::vector<int> head(1 << kHashBits, -1);
+    size_t size = data.size();
+    size_t i = 0;
+    while (i < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (i + 3 <= size) {
+            uint32_t hash = ((data[i] << 16) | (data[i + 1] << 8) | data[i + 2]) * 2654435761u >> (32 - kHashBits);
+            int candidate = head[hash];
+            head[hash] = (int)i;
+            if (candidate >= 0 && (int)i - candidate <= kWindow) {
+                size_t maxLength = std::min((size_t)kMaxMatch, size - i);
+                size_t length = 0;
+                while (length < maxLength && data[candidate + length] == data[i + length]) {
+                    length++;
+                }
+                if (length >= 3) {
+                    bestLength = (int)length;
+                    bestDistance = (int)i - candidate;
+                }
+            }
+        }
+
+        if (bestLength > 0) {
+            writeMatch(bits, bestLength, bestDistance);
+            // Keep the hash table current inside the match, but not for every byte of long runs
+            size_t end = i + bestLength;
+            for (size_t j = i + 1; j + 3 <= size && j < end && j < i + 16; j++) {
+                uint32_t hash = ((data[j] << 16) | (data[j + 1] << 8) | data[j + 2]) * 2654435761u >> (32 - kHashBits);
+                head[hash] = (int)j;
+            }
+            i = end;
+        } else {
+            writeLiteralLength(bits, data[i]);
+            i++;
+        }
+    }
+    writeLiteralLength(bits, 256);
+    bits.flush();
+
+    uint32_t adler = adler32(data.data(), data.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((unsigned char)(adler >> shift));
+    }
+    return out;
+}
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data) {
+    unsigned char header[8];
+    uint32_t length = (uint32_t)data.size();
+    for (int i = 0; i < 4; i++) {
+        header[i] = (unsigned char)(length >> (24 - 8 * i));
+    }
+    std::memcpy(header + 4, type, 4);
+    uint32_t crc = crc32(header + 4, 4);
+    crc = crc32(data.data(), data.size(), crc);
+
+    unsigned char footer[4];
+    for (int i = 0; i < 4; i++) {
+        footer[i] = (unsigned char)(crc >> (24 - 8 * i));
+    }
+    file.write((const char*)header, 8);
+    file.write((const char*)data.data(), data.size());
+    file.write((const char*)footer, 4);
+}
+
+}  // namespace
+
+bool writePng(const std::string& path, int width, int height, int channels,
+              const unsigned char* pixels, ptrdiff_t rowStride) {
+    if (channels != 3 && channels != 4) {
+        std::cerr << "PNG output needs RGB or RGBA pixels" << std::endl;
+        return false;
+    }
+
+    // Each row gets the filter with the smallest sum of absolute residuals
+    // (the usual heuristic): None, Sub, Up or Paeth
+    size_t rowBytes = (size_t)width * channels;
+    std::vector<unsigned char> filtered((rowBytes + 1) * height);
+    std::vector<unsigned char> candidate(rowBytes);
+    std::vector<unsigned char> zeroRow(rowBytes, 0);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = pixels + y * rowStride;
+        const unsigned char* above = y > 0 ? pixels + (y - 1) * rowStride : zeroRow.data();
+        unsigned char* out = &filtered[y * (rowBytes + 1)];
+
+        long bestScore = -1;
+        for (int filter = 0; filter < 5; filter++) {
+            if (filter == 3) {
+                continue;   // Average rarely wins on rendered frames
+            }
+            long score = 0;
+            for (size_t x = 0; x < rowBytes; x++) {
+                int left = x >= (size_t)channels ? row[x - channels] : 0;
+                int upLeft = x >= (size_t)channels ? above[x - channels] : 0;
+                int predicted = filter == 0 ? 0 : filter == 1 ? left : filter == 2 ? above[x] : paeth(left, above[x], upLeft);
+                candidate[x] = (unsigned char)(row[x] - predicted);
+                score += candidate[x] < 128 ? candidate[x] : 256 - candidate[x];
+            }
+            if (bestScore < 0 || score < bestScore) {
+                bestScore = score;
+                out[0] = (unsigned char)filter;
+                std::memcpy(out + 1, candidate.data(), rowBytes);
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write((const char*)signature, 8);
+
+    std::vector<unsigned char> header(13, 0);
+    for (int i = 0; i < 4; i++) {
+        header[i] = (unsigned char)(width >> (24 - 8 * i));
+        header[4 + i] = (unsigned char)(height >> (24 - 8 * i));
+    }
+    header[8] = 8;                        // bit depth
+    header[9] = channels == 4 ? 6 : 2;    // RGBA or RGB
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", zlibCompress(filtered));
+    writeChunk(file, "IEND", {});
+    return (bool)file;
+}
+
+bool writePpm(const std::string& path, int width, int height, int channels,
+              const unsigned char* pixels, ptrdiff_t rowStride) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<unsigned char> row((size_t)width * 3);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* source = pixels + y * rowStride;
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                row[x * 3 + c] = source[x * channels + (channels >= 3 ? c : 0)];
+            }
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+    return (bool)file;
+}
+
+bool writeImage(const std::string& path, int width, int height, int channels,
+                const unsigned char* pixels, ptrdiff_t rowStride) {
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    if (extension == ".png") {
+        return writePng(path, width, height, channels, pixels, rowStride);
+    }
+    if (extension == ".ppm") {
+        return writePpm(path, width, height, channels, pixels, rowStride);
+    }
+    std::cerr << "Unsupported image format: " << path << " (expected .png or .ppm)" << std::endl;
+    return false;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 8-bit image files from memory, without third-party code:
+//   .png  RGB or RGBA, deflate-compressed (fixed Huffman codes, LZ77 matching)
+//   .ppm  binary RGB (alpha dropped), no compression
+//
+// pixels points at the first row written (the top of the image) and rows are
+// rowStride bytes apart. A negative stride writes a bottom-up buffer, such as
+// glReadPixels output, top-down without copying it.
+bool writePng(const std::string& path, int width, int height, int channels,
+              const unsigned char* pixels, ptrdiff_t rowStride);
+bool writePpm(const std::string& path, int width, int height, int channels,
+              const unsigned char* pixels, ptrdiff_t rowStride);
+
+// Picks the format from the file extension (.png or .ppm)
+bool writeImage(const std::string& path, int width, int height, int channels,
+                const unsigned char* pixels, ptrdiff_t rowStride);
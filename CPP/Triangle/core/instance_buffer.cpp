@@ -0,0 +1,77 @@
+#include "instance_buffer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <glm/gtc/matrix_transform.hpp>
+
+InstanceBuffer::InstanceBuffer() : buffer(0), count(0) {}
+
+InstanceBuffer::~InstanceBuffer() {
+    destroy();
+}
+
+bool InstanceBuffer::create(GLuint vao, GLuint firstLocation, const std::vector<glm::mat4>& transforms) {
+    destroy();
+    count = (GLsizei)transforms.size();
+
+    glGenBuffers(1, &buffer);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4), transforms.data(), GL_STATIC_DRAW);
+
+    // A mat4 attribute occupies four vec4 locations, one per column
+    for (GLuint column = 0; column < 4; column++) {
+        GLuint location = firstLocation + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer != 0;
+}
+
+void InstanceBuffer::destroy() {
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    count = 0;
+}
+
+// Small integer hash, so layouts are identical on every platform and standard library
+static float hashToUnit(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+std::vector<glm::mat4> makeInstanceGrid(int count, float extent) {
+    std::vector<glm::mat4> transforms;
+    if (count <= 0) {
+        return transforms;
+    }
+    transforms.reserve(count);
+
+    int side = (int)std::ceil(std::sqrt((double)count));
+    float spacing = 2.0f * extent / side;
+
+    for (int i = 0; i < count; i++) {
+        int column = i % side;
+        int row = i / side;
+        glm::vec3 position(-extent + (column + 0.5f) * spacing, -extent + (row + 0.5f) * spacing, 0.0f);
+
+        float angle = hashToUnit((uint32_t)i * 3u) * 6.2831853f;
+        glm::vec3 axis(hashToUnit((uint32_t)i * 3u + 1u) - 0.5f, hashToUnit((uint32_t)i * 3u + 2u) - 0.5f, 1.0f);
+
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+        transform = glm::rotate(transform, angle, glm::normalize(axis));
+        transform = glm::scale(transform, glm::vec3(spacing * 0.9f));
+        transforms.push_back(transform);
+    }
+    return transforms;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Per-instance model matrices for glDrawArraysInstanced. The matrices live in
+// their own VBO and are exposed to the vertex shader as a mat4 attribute
+// (four consecutive vec4 locations starting at firstLocation) that advances
+// once per instance.
+class InstanceBuffer {
+private:
+    GLuint buffer;
+    GLsizei count;
+
+public:
+    InstanceBuffer();
+    ~InstanceBuffer();
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Uploads the matrices and adds the attribute to the given VAO
+    bool create(GLuint vao, GLuint firstLocation, const std::vector<glm::mat4>& transforms);
+    void destroy();
+
+    GLsizei getCount() const { return count; }
+};
+
+// Deterministic layout of `count` small triangles on a grid in the z = 0 plane,
+// covering [-extent, extent] in x and y, each with its own rotation and
+// uniform scale. Only rotation, translation and uniform scale are used, so
+// mat3(transform) is a valid normal matrix up to length.
+std::vector<glm::mat4> makeInstanceGrid(int count, float extent);
@@ -0,0 +1,366 @@
+#include "ktx_texture.h"
+#include "gl_extensions.h"
+#include "mapped_file.h"
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// Header (identifier + 9 fields), index (4 x uint32 + 2 x uint64), then one
+// 24-byte level index entry per level
+static const size_t headerSize = 80;
+static const size_t levelIndexEntrySize = 24;
+
+// Which driver feature a format needs
+enum class KtxSupport { Core, S3tc, Bptc };
+
+// Uncompressed formats have 1x1 texel blocks; compressed ones 4x4 blocks,
+// described in the data format descriptor by their color model
+struct KtxFormat {
+    uint32_t vkFormat;
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    uint32_t blockBytes;
+    uint32_t blockSize;
+    uint32_t colorModel;
+    bool srgb;
+    KtxSupport support;
+    const char* name;
+};
+
+static const uint32_t colorModelRgbsda = 1;
+static const uint32_t colorModelBc1a = 128;
+static const uint32_t colorModelBc3 = 130;
+static const uint32_t colorModelBc7 = 134;
+
+static const KtxFormat ktxFormats[] = {
+    { kVkFormatR8G8B8A8Unorm, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 1, colorModelRgbsda, false, KtxSupport::Core, "RGBA8" },
+    { kVkFormatR8G8B8A8Srgb, GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 1, colorModelRgbsda, true, KtxSupport::Core, "sRGB8 A8" },
+    { kVkFormatBc1RgbUnorm, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, 0, 8, 4, colorModelBc1a, false, KtxSupport::S3tc, "BC1" },
+    { kVkFormatBc1RgbSrgb, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 0, 0, 8, 4, colorModelBc1a, true, KtxSupport::S3tc, "BC1 sRGB" },
+    { kVkFormatBc3Unorm, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0, 16, 4, colorModelBc3, false, KtxSupport::S3tc, "BC3" },
+    { kVkFormatBc3Srgb, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 0, 0, 16, 4, colorModelBc3, true, KtxSupport::S3tc, "BC3 sRGB" },
+    { kVkFormatBc7Unorm, GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0, 16, 4, colorModelBc7, false, KtxSupport::Bptc, "BC7" },
+    { kVkFormatBc7Srgb, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 0, 0, 16, 4, colorModelBc7, true, KtxSupport::Bptc, "BC7 sRGB" },
+};
+
+static const KtxFormat* findFormat(uint32_t vkFormat) {
+    for (const KtxFormat& format : ktxFormats) {
+        if (format.vkFormat == vkFormat) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
+// All supported platforms are little-endian, like the file format
+static uint32_t readU32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t readU64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void appendU32(std::vector<unsigned char>& out, uint32_t value) {
+    unsigned char bytes[4];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+static void appendU64(std::vector<unsigned char>& out, uint64_t value) {
+    unsigned char bytes[8];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.insert(out.end(), bytes, bytes + 8);
+}
+
+static void writeU64At(std::vector<unsigned char>& out, size_t offset, uint64_t value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static int levelDimension(int size, int level) {
+    int result = size >> level;
+    return result > 0 ? result : 1;
+}
+
+static size_t levelSize(const KtxFormat& format, int width, int height) {
+    size_t blocksX = (width + format.blockSize - 1) / format.blockSize;
+    size_t blocksY = (height + format.blockSize - 1) / format.blockSize;
+    return blocksX * blocksY * format.blockBytes;
+}
+
+bool parseKtx2(const unsigned char* data, size_t size, KtxImage& image, const std::string& name) {
+    auto fail = [&name](const char* reason) {
+        std::cerr << "Invalid KTX2 file " << name << ": " << reason << std::endl;
+        return false;
+    };
+
+    if (size < headerSize || std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+        return fail("bad identifier");
+    }
+    uint32_t vkFormat = readU32(data + 12);
+    uint32_t width = readU32(data + 20);
+    uint32_t height = readU32(data + 24);
+    uint32_t depth = readU32(data + 28);
+    uint32_t layerCount = readU32(data + 32);
+    uint32_t faceCount = readU32(data + 36);
+    uint32_t levelCount = readU32(data + 40);
+    uint32_t supercompression = readU32(data + 44);
+
+    const KtxFormat* format = findFormat(vkFormat);
+    if (!format) {
+        return fail("unsupported format");
+    }
+    if (width == 0 || height == 0 || width > 65536 || height > 65536 || depth != 0 || layerCount > 1 || faceCount != 1) {
+        return fail("only single 2D images are supported");
+    }
+    if (supercompression != 0) {
+        return fail("supercompressed files are not supported");
+    }
+
+    // Level count 0 asks the loader to generate mipmaps; the file still has level 0
+    levelCount = levelCount == 0 ? 1 : levelCount;
+    uint32_t maxLevels = 1;
+    while (((width | height) >> maxLevels) != 0) {
+        maxLevels++;
+    }
+    if (levelCount > maxLevels || size < headerSize + levelCount * levelIndexEntrySize) {
+        return fail("bad level count");
+    }
+
+    image.vkFormat = vkFormat;
+    image.width = (int)width;
+    image.height = (int)height;
+    image.levels.clear();
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const unsigned char* entry = data + headerSize + level * levelIndexEntrySize;
+        uint64_t offset = readU64(entry);
+        uint64_t length = readU64(entry + 8);
+
+        KtxLevel result;
+        result.width = levelDimension((int)width, (int)level);
+        result.height = levelDimension((int)height, (int)level);
+        uint64_t expected = levelSize(*format, result.width, result.height);
+        if (length != expected || offset > size || length > size - offset) {
+            return fail("level data out of range");
+        }
+        result.data = data + offset;
+        result.size = (size_t)length;
+        image.levels.push_back(result);
+    }
+    return true;
+}
+
+// Basic data format descriptor: BT.709 primaries, sRGB or linear transfer.
+// RGBA8 has one 8-bit sample per channel; a compressed block is described as
+// a whole (BC3 as its alpha half, then its colour half).
+static std::vector<unsigned char> makeDescriptor(const KtxFormat& format) {
+    struct Sample {
+        uint32_t bitOffset, bitLength, channel, upper;
+    };
+    // At most four samples, one per channel
+    Sample samples[4];
+    uint32_t sampleCount;
+    if (format.colorModel == colorModelRgbsda) {
+        samples[0] = { 0, 8, 0, 255 };
+        samples[1] = { 8, 8, 1, 255 };
+        samples[2] = { 16, 8, 2, 255 };
+        samples[3] = { 24, 8, 15, 255 };
+        sampleCount = 4;
+    } else if (format.colorModel == colorModelBc3) {
+        samples[0] = { 0, 64, 15, 0xffffffffu };
+        samples[1] = { 64, 64, 0, 0xffffffffu };
+        sampleCount = 2;
+    } else {
+        samples[0] = { 0, format.blockBytes * 8, 0, 0xffffffffu };
+        sampleCount = 1;
+    }
+
+    const uint32_t blockSize = 24 + 16 * sampleCount;
+    const uint32_t blockDimension = format.blockSize - 1;
+    std::vector<unsigned char> dfd;
+    appendU32(dfd, 4 + blockSize);            // dfdTotalSize
+    appendU32(dfd, 0);                        // vendor 0 (Khronos), descriptor type 0 (basic)
+    appendU32(dfd, 2 | (blockSize << 16));    // version 2
+    appendU32(dfd, format.colorModel | (1 << 8) | ((format.srgb ? 2u : 1u) << 16));
+    appendU32(dfd, blockDimension | (blockDimension << 8));  // texel block size minus one
+    appendU32(dfd, format.blockBytes);        // bytes in plane 0
+    appendU32(dfd, 0);
+
+    for (uint32_t i = 0; i < sampleCount; i++) {
+        const Sample& sample = samples[i];
+        // Alpha is never sRGB encoded: flag it as linear in sRGB formats
+        uint32_t qualifiers = (format.srgb && sample.channel == 15) ? 0x10 : 0;
+        appendU32(dfd, sample.bitOffset | ((sample.bitLength - 1) << 16) | ((sample.channel | qualifiers) << 24));
+        appendU32(dfd, 0);              // sample position
+        appendU32(dfd, 0);              // lower
+        appendU32(dfd, sample.upper);
+    }
+    return dfd;
+}
+
+bool writeKtx2(const std::string& path, uint32_t vkFormat, int width, int height,
+               const std::vector<std::vector<unsigned char>>& levels) {
+    const KtxFormat* format = findFormat(vkFormat);
+    if (!format || levels.empty() || width <= 0 || height <= 0) {
+        std::cerr << "Cannot write " << path << ": unsupported format or empty image" << std::endl;
+        return false;
+    }
+    for (size_t level = 0; level < levels.size(); level++) {
+        size_t expected = levelSize(*format, levelDimension(width, (int)level), levelDimension(height, (int)level));
+        if (levels[level].size() != expected) {
+            std::cerr << "Cannot write " << path << ": level " << level << " has the wrong size" << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t levelCount = (uint32_t)levels.size();
+    std::vector<unsigned char> dfd = makeDescriptor(*format);
+
+    // One key/value pair: rows are stored bottom-up ("r"ight, "u"p)
+    std::vector<unsigned char> kvd;
+    const char key[] = "KTXorientation";
+    const char value[] = "ru";
+    appendU32(kvd, (uint32_t)(sizeof(key) + sizeof(value)));
+    kvd.insert(kvd.end(), key, key + sizeof(key));
+    kvd.insert(kvd.end(), value, value + sizeof(value));
+    kvd.resize(alignUp(kvd.size(), 4), 0);
+
+    size_t dfdOffset = headerSize + levelCount * levelIndexEntrySize;
+    size_t kvdOffset = dfdOffset + dfd.size();
+
+    std::vector<unsigned char> file(ktx2Identifier, ktx2Identifier + sizeof(ktx2Identifier));
+    appendU32(file, vkFormat);
+    appendU32(file, 1);  // typeSize: 8-bit components
+    appendU32(file, (uint32_t)width);
+    appendU32(file, (uint32_t)height);
+    appendU32(file, 0);  // pixelDepth
+    appendU32(file, 0);  // layerCount
+    appendU32(file, 1);  // faceCount
+    appendU32(file, levelCount);
+    appendU32(file, 0);  // no supercompression
+    appendU32(file, (uint32_t)dfdOffset);
+    appendU32(file, (uint32_t)dfd.size());
+    appendU32(file, (uint32_t)kvdOffset);
+    appendU32(file, (uint32_t)kvd.size());
+    appendU64(file, 0);  // no supercompression global data
+    appendU64(file, 0);
+
+    size_t levelIndexOffset = file.size();
+    file.resize(file.size() + levelCount * levelIndexEntrySize, 0);
+    file.insert(file.end(), dfd.begin(), dfd.end());
+    file.insert(file.end(), kvd.begin(), kvd.end());
+
+    // Level data goes smallest first, each level aligned to the texel block size
+    // (and to 4), so a streaming reader can show low mips before the rest arrives
+    for (int level = (int)levelCount - 1; level >= 0; level--) {
+        file.resize(alignUp(file.size(), format->blockBytes), 0);
+        size_t entry = levelIndexOffset + level * levelIndexEntrySize;
+        writeU64At(file, entry, file.size());
+        writeU64At(file, entry + 8, levels[level].size());
+        writeU64At(file, entry + 16, levels[level].size());
+        file.insert(file.end(), levels[level].begin(), levels[level].end());
+    }
+
+    // Write to a temporary name and rename it over the target: a reader that
+    // has the old file mapped keeps its contents, where rewriting in place
+    // would change them under it (see openSharedMappedFile())
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        if (!out.write((const char*)file.data(), file.size())) {
+            std::cerr << "Failed to write " << temporary << std::endl;
+            out.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        // Windows does not rename over an existing file
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to write " << path << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isKtx2FormatSupported(uint32_t vkFormat) {
+    const KtxFormat* format = findFormat(vkFormat);
+    if (!format) {
+        return false;
+    }
+    switch (format->support) {
+    case KtxSupport::S3tc:
+        return getGLExtensions().textureCompressionS3tc;
+    case KtxSupport::Bptc:
+        return getGLExtensions().textureCompressionBptc;
+    default:
+        return true;
+    }
+}
+
+GLuint loadKtx2Texture(const std::string& path) {
+    TraceZone zone("load ktx2", "texture");
+    auto start = std::chrono::steady_clock::now();
+
+    // Shared with other loads of the same file; every level is read in order
+    std::shared_ptr<const MappedFile> file = openSharedMappedFile(path, MapAccess::Sequential);
+    if (!file) {
+        return 0;
+    }
+    KtxImage image;
+    if (!parseKtx2(file->data(), file->size(), image, path)) {
+        return 0;
+    }
+    const KtxFormat* format = findFormat(image.vkFormat);
+    if (!isKtx2FormatSupported(image.vkFormat)) {
+        std::cerr << "Skipping " << path << ": this driver cannot sample " << format->name << " textures" << std::endl;
+        return 0;
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // KTX2 rows are tightly packed. glTexImage2D has consumed the client
+    // memory when it returns, so the mapping can go away right after.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < image.levels.size(); level++) {
+        const KtxLevel& data = image.levels[level];
+        if (format->blockSize > 1) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format->internalFormat, data.width, data.height, 0,
+                                   (GLsizei)data.size, data.data);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, format->internalFormat, data.width, data.height, 0,
+                         format->format, format->type, data.data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t bytes = 0;
+    for (const KtxLevel& level : image.levels) {
+        bytes += level.size;
+    }
+    std::cout << "Loaded " << path << ": " << image.width << "x" << image.height << " " << format->name << ", "
+              << image.levels.size() << " levels, " << bytes / 1024 << " KiB (" << ms << " ms)" << std::endl;
+    return texture;
+}
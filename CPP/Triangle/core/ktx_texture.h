@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// KTX2 (Khronos texture container) support for textures baked offline by
+// texture_baker: mip-chained, GPU-ready pixel data that is uploaded straight
+// from a memory mapping of the file, with no decode and no intermediate copy.
+//
+// Only what the bakers write is accepted: 2D, one layer, one face, no
+// supercompression. Rows are stored bottom-up, as glTexImage2D expects
+// (KTXorientation "ru").
+
+// Vulkan format numbers used in the KTX2 header
+constexpr uint32_t kVkFormatR8G8B8A8Unorm = 37;
+constexpr uint32_t kVkFormatR8G8B8A8Srgb = 43;
+// Block-compressed formats (see block_compress.h); they need driver support
+// (EXT_texture_compression_s3tc for BC1/BC3, GL 4.2 or ARB_texture_compression_bptc for BC7)
+constexpr uint32_t kVkFormatBc1RgbUnorm = 131;
+constexpr uint32_t kVkFormatBc1RgbSrgb = 132;
+constexpr uint32_t kVkFormatBc3Unorm = 137;
+constexpr uint32_t kVkFormatBc3Srgb = 138;
+constexpr uint32_t kVkFormatBc7Unorm = 145;
+constexpr uint32_t kVkFormatBc7Srgb = 146;
+
+struct KtxLevel {
+    const unsigned char* data;
+    size_t size;
+    int width;
+    int height;
+};
+
+struct KtxImage {
+    uint32_t vkFormat;
+    int width;
+    int height;
+    std::vector<KtxLevel> levels;  // level 0 (full size) first
+};
+
+// Validates a KTX2 file in memory; the levels point into `data`. `name` is
+// used in error messages.
+bool parseKtx2(const unsigned char* data, size_t size, KtxImage& image, const std::string& name);
+
+// Writes a KTX2 file; levels[0] is the full-size image, each following level
+// half the size of the previous one (rounded down, at least 1). Block-compressed
+// levels hold whole 4x4 blocks. The file is written under a temporary name and
+// renamed over `path`, so readers that have the old one mapped are unaffected.
+bool writeKtx2(const std::string& path, uint32_t vkFormat, int width, int height,
+               const std::vector<std::vector<unsigned char>>& levels);
+
+// Whether the current context can sample textures of this format
+bool isKtx2FormatSupported(uint32_t vkFormat);
+
+// Maps the file, creates a texture and uploads every level directly from the
+// mapping (block-compressed formats with glCompressedTexImage2D). Returns 0 on
+// failure, including a format the driver cannot sample; leaves the texture
+// bound to GL_TEXTURE_2D.
+GLuint loadKtx2Texture(const std::string& path);
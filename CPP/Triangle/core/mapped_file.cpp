@@ -0,0 +1,184 @@
+#include "mapped_file.h"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static int64_t toNanoseconds(const FILETIME& time) {
+    // FILETIME counts 100 ns intervals
+    return (int64_t)(((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime) * 100;
+}
+#else
+static int64_t toNanoseconds(const struct stat& info) {
+#if defined(__APPLE__)
+    return (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    return (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+// Size and modification time without opening the file; false if it is missing
+static bool getFileStamp(const std::string& path, size_t& size, int64_t& modified) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) {
+        return false;
+    }
+    size = (size_t)(((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow);
+    modified = toNanoseconds(attributes.ftLastWriteTime);
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    size = (size_t)info.st_size;
+    modified = toNanoseconds(info);
+#endif
+    return true;
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile() : bytes(nullptr), length(0), modified(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+#else
+MappedFile::MappedFile() : bytes(nullptr), length(0), modified(0) {}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, MapAccess access) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        std::cerr << "Failed to map " << path << ": empty or unreadable file" << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        std::cerr << "Failed to map " << path << std::endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    FILETIME writeTime;
+    GetFileTime(file, nullptr, nullptr, &writeTime);
+    fileHandle = file;
+    mappingHandle = mapping;
+    bytes = (const unsigned char*)view;
+    length = (size_t)fileSize.QuadPart;
+    modified = toNanoseconds(writeTime);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Failed to map " << path << ": empty or unreadable file" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive; the descriptor is no longer needed
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        std::cerr << "Failed to map " << path << std::endl;
+        return false;
+    }
+    bytes = (const unsigned char*)view;
+    length = (size_t)info.st_size;
+    modified = toNanoseconds(info);
+#endif
+    advise(access);
+    return true;
+}
+
+void MappedFile::close() {
+    if (!bytes) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap((void*)bytes, length);
+#endif
+    bytes = nullptr;
+    length = 0;
+    modified = 0;
+}
+
+void MappedFile::advise(MapAccess access) const {
+#ifndef _WIN32
+    if (!bytes || access == MapAccess::Normal) {
+        return;
+    }
+    // Hints only: a kernel that ignores them just pages in on demand
+    madvise((void*)bytes, length, MADV_SEQUENTIAL);
+    madvise((void*)bytes, length, MADV_WILLNEED);
+#else
+    (void)access;
+#endif
+}
+
+static std::mutex cacheMutex;
+static std::unordered_map<std::string, std::shared_ptr<const MappedFile>> cache;
+
+std::shared_ptr<const MappedFile> openSharedMappedFile(const std::string& path, MapAccess access) {
+    size_t size = 0;
+    int64_t modified = 0;
+    bool exists = getFileStamp(path, size, modified);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        const MappedFile& file = *found->second;
+        if (exists && file.size() == size && file.modifiedTime() == modified) {
+            file.advise(access);
+            return found->second;
+        }
+        // Replaced by rename or deleted since it was mapped: holders keep the
+        // old contents. A file rewritten in place or truncated changes under
+        // their mapping instead, and reading past a new end raises SIGBUS.
+        cache.erase(found);
+    }
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(path, access)) {
+        return nullptr;
+    }
+    cache[path] = file;
+    return file;
+}
+
+void clearMappedFileCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+}
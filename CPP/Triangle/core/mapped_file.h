@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// How a mapping is about to be read, passed on to the OS as a paging hint
+enum class MapAccess {
+    Normal,
+    Sequential  // read once, front to back, soon: read ahead aggressively
+};
+
+// Read-only memory mapping of a whole file. The contents are paged in by the
+// OS on first access, so nothing is read or copied up front.
+class MappedFile {
+private:
+    const unsigned char* bytes;
+    size_t length;
+    int64_t modified;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False (with a message) if the file cannot be opened or mapped
+    bool open(const std::string& path, MapAccess access = MapAccess::Normal);
+    void close();
+
+    // madvise() hint for the whole mapping (no-op on Windows)
+    void advise(MapAccess access) const;
+
+    bool isOpen() const { return bytes != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    // Modification time when opened, in nanoseconds (only compared, never shown)
+    int64_t modifiedTime() const { return modified; }
+};
+
+// Process-wide cache of read-only mappings keyed by path, size and
+// modification time: a file opened again while unchanged reuses its mapping,
+// a changed one is mapped afresh. Mapped pages live in the OS page cache, so
+// other processes opening the same file share them too, with no stdio
+// buffering in between. Safe to call from any thread; null (with a message)
+// on failure.
+//
+// Mappings are only safe against files that are replaced, not rewritten: a
+// writer must write a new file and rename it over the old one (as
+// writeKtx2() does). Rewriting or truncating a mapped file in place changes
+// what its holders read and can crash them with SIGBUS.
+std::shared_ptr<const MappedFile> openSharedMappedFile(const std::string& path, MapAccess access = MapAccess::Normal);
+
+// Drops the cache's references; mappings still in use stay open until released
+void clearMappedFileCache();
@@ -0,0 +1,218 @@
+#include "mip_builder.h"
+#include "mip_kernels.h"
+#include "row_bands.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// Kaiser filter: 12 taps per axis (6 output texels of support), alpha 4
+static const int kaiserTaps = 12;
+static const int kaiserLeft = 5;  // taps before the first input texel of an output texel
+static const float kaiserWidth = 3.0f;
+static const float kaiserAlpha = 4.0f;
+
+// Levels smaller than this are filtered on the calling thread only
+static const size_t minParallelTexels = 16384;
+
+static const float pi = 3.14159265358979f;
+
+// sRGB <-> linear tables; encoding looks up the linear value quantized to 14 bits,
+// which is within 0.2 of an 8-bit step even near black
+static const int encodeTableSize = 16384;
+
+struct SrgbTables {
+    float decode[256];
+    unsigned char encode[encodeTableSize];
+
+    SrgbTables() {
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < encodeTableSize; i++) {
+            float l = (float)i / (encodeTableSize - 1);
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            encode[i] = (unsigned char)(c * 255.0f + 0.5f);
+        }
+    }
+};
+
+static const SrgbTables& srgbTables() {
+    static const SrgbTables tables;
+    return tables;
+}
+
+int mipLevelCount(int width, int height) {
+    int levels = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+        levels++;
+    }
+    return levels;
+}
+
+const char* mipFilterName(MipFilter filter) {
+    return filter == MipFilter::Kaiser ? "kaiser" : "box";
+}
+
+// Zeroth-order modified Bessel function of the first kind (series expansion)
+static float besselI0(float x) {
+    float sum = 1.0f, term = 1.0f;
+    for (int k = 1; k < 30; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Output texel x covers input texels 2x and 2x+1, so its centre is at input
+// coordinate 2x+1; tap k sits on input texel 2x-5+k, (k-5.5)/2 output texels away
+static void computeKaiserWeights(float* weights) {
+    float total = 0.0f;
+    for (int k = 0; k < kaiserTaps; k++) {
+        float d = (k - kaiserLeft - 0.5f) * 0.5f;
+        float sinc = std::sin(pi * d) / (pi * d);
+        float t = d / kaiserWidth;
+        float window = besselI0(kaiserAlpha * std::sqrt(std::max(0.0f, 1.0f - t * t))) / besselI0(kaiserAlpha);
+        weights[k] = sinc * window;
+        total += weights[k];
+    }
+    for (int k = 0; k < kaiserTaps; k++) {
+        weights[k] /= total;
+    }
+}
+
+// Splits [0, rows) across the shared pool; small levels run on the calling thread
+static void forEachLevelBand(const MipOptions& options, int rows, size_t texels,
+                             const std::function<void(int, int)>& band) {
+    forEachRowBand(rows, texels < minParallelTexels ? 1 : options.threads, band);
+}
+
+// Per-channel layout: the last channel is alpha for 2 and 4 channels, the
+// others are colour
+struct ChannelLayout {
+    int channels;
+    int colourChannels;
+    bool srgb;
+};
+
+static void decodeRow(const unsigned char* in, int width, const ChannelLayout& layout, float* out) {
+    const float* decode = srgbTables().decode;
+    for (int x = 0; x < width; x++) {
+        for (int c = 0; c < 4; c++) {
+            float value = 1.0f;
+            if (c < layout.channels) {
+                unsigned char byte = in[x * layout.channels + c];
+                value = layout.srgb && c < layout.colourChannels ? decode[byte] : byte / 255.0f;
+            }
+            out[x * 4 + c] = value;
+        }
+    }
+}
+
+// Linear RGBA goes through the SIMD kernel; everything else per channel
+static void encodeRow(const MipKernels& kernels, const float* in, int width, const ChannelLayout& layout, unsigned char* out) {
+    if (layout.channels == 4 && !layout.srgb) {
+        kernels.toUnorm8(in, out, width * 4);
+        return;
+    }
+    const unsigned char* encode = srgbTables().encode;
+    for (int x = 0; x < width; x++) {
+        for (int c = 0; c < layout.channels; c++) {
+            float value = in[x * 4 + c];
+            out[x * layout.channels + c] = layout.srgb && c < layout.colourChannels
+                                               ? encode[(int)(value * (encodeTableSize - 1) + 0.5f)]
+                                               : (unsigned char)(value * 255.0f + 0.5f);
+        }
+    }
+}
+
+bool buildMipChain(const unsigned char* pixels, int width, int height, int channels, const MipOptions& options,
+                   std::vector<std::vector<unsigned char>>& mips) {
+    mips.clear();
+    if (!pixels || width < 1 || height < 1 || channels < 1 || channels > 4) {
+        return false;
+    }
+    TraceZone zone("build mips", "texture");
+
+    ChannelLayout layout;
+    layout.channels = channels;
+    layout.colourChannels = channels == 2 || channels == 4 ? channels - 1 : channels;
+    layout.srgb = options.srgb;
+
+    const MipKernels& kernels = getMipKernels(std::min(detectSimdLevel(), options.maxSimd));
+
+    float kaiserWeights[kaiserTaps];
+    computeKaiserWeights(kaiserWeights);
+
+    // The previous level in linear float RGBA
+    std::vector<float> source((size_t)width * height * 4);
+    forEachLevelBand(options, height, (size_t)width * height, [&](int first, int last) {
+        for (int y = first; y < last; y++) {
+            decodeRow(pixels + (size_t)y * width * channels, width, layout, &source[(size_t)y * width * 4]);
+        }
+    });
+
+    std::vector<float> target, horizontal;
+    int inWidth = width, inHeight = height;
+    while (inWidth > 1 || inHeight > 1) {
+        int outWidth = std::max(inWidth / 2, 1);
+        int outHeight = std::max(inHeight / 2, 1);
+        target.resize((size_t)outWidth * outHeight * 4);
+        mips.emplace_back((size_t)outWidth * outHeight * channels);
+        unsigned char* output = mips.back().data();
+        size_t outTexels = (size_t)outWidth * outHeight;
+
+        if (options.filter == MipFilter::Box) {
+            forEachLevelBand(options, outHeight, outTexels, [&](int first, int last) {
+                for (int y = first; y < last; y++) {
+                    int y0 = std::min(y * 2, inHeight - 1);
+                    int y1 = std::min(y * 2 + 1, inHeight - 1);
+                    float* row = &target[(size_t)y * outWidth * 4];
+                    kernels.boxRow(&source[(size_t)y0 * inWidth * 4], &source[(size_t)y1 * inWidth * 4], inWidth,
+                                   row, outWidth);
+                    encodeRow(kernels, row, outWidth, layout, output + (size_t)y * outWidth * channels);
+                }
+            });
+        } else {
+            // Horizontal pass over every input row, with the row's edge texels
+            // repeated so the kernel needs no bounds checks
+            horizontal.resize((size_t)outWidth * inHeight * 4);
+            int paddedWidth = 2 * outWidth + kaiserTaps - 2;
+            forEachLevelBand(options, inHeight, (size_t)outWidth * inHeight, [&](int first, int last) {
+                std::vector<float> padded((size_t)paddedWidth * 4);
+                for (int y = first; y < last; y++) {
+                    const float* in = &source[(size_t)y * inWidth * 4];
+                    for (int i = 0; i < paddedWidth; i++) {
+                        int x = std::min(std::max(i - kaiserLeft, 0), inWidth - 1);
+                        std::copy(in + x * 4, in + x * 4 + 4, &padded[(size_t)i * 4]);
+                    }
+                    kernels.horizontalRow(padded.data(), kaiserWeights, kaiserTaps,
+                                          &horizontal[(size_t)y * outWidth * 4], outWidth);
+                }
+            });
+
+            // Vertical pass, clamping rows at the top and bottom edges
+            forEachLevelBand(options, outHeight, outTexels, [&](int first, int last) {
+                const float* rows[kaiserTaps];
+                for (int y = first; y < last; y++) {
+                    for (int k = 0; k < kaiserTaps; k++) {
+                        int inY = std::min(std::max(2 * y - kaiserLeft + k, 0), inHeight - 1);
+                        rows[k] = &horizontal[(size_t)inY * outWidth * 4];
+                    }
+                    float* row = &target[(size_t)y * outWidth * 4];
+                    kernels.verticalRow(rows, kaiserWeights, kaiserTaps, row, outWidth * 4);
+                    encodeRow(kernels, row, outWidth, layout, output + (size_t)y * outWidth * channels);
+                }
+            });
+        }
+
+        source.swap(target);
+        inWidth = outWidth;
+        inHeight = outHeight;
+    }
+    return true;
+}
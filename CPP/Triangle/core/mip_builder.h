@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "softraster/cpu_features.h"
+
+// Builds texture mip chains on the CPU, so every level can be uploaded
+// explicitly instead of relying on glGenerateMipmap, whose filter is up to the
+// driver and which is slow on software GL.
+//
+// Each level is filtered from the previous one in linear-light float RGBA, so
+// rounding does not build up down the chain. With srgb set, colour channels
+// are decoded from sRGB before filtering and encoded again afterwards (alpha
+// is always linear), which keeps bright detail from darkening as it shrinks.
+// Rows of a level are split across the shared worker pool (see row_bands.h),
+// and the filter loops run in SSE4.1 or AVX2 when the CPU has them.
+
+enum class MipFilter {
+    Box,    // 2x2 average, cheapest
+    Kaiser  // Kaiser-windowed sinc over 12x12 texels, sharper and less aliasing
+};
+
+struct MipOptions {
+    MipFilter filter = MipFilter::Box;
+    bool srgb = true;
+    int threads = 0;                       // 0 = one per hardware thread
+    SimdLevel maxSimd = SimdLevel::AVX2;   // caps the kernels, for comparisons
+};
+
+// Number of levels in a full chain down to 1x1
+int mipLevelCount(int width, int height);
+
+// Fills mips with levels 1 and up of a full chain for an image of 1 to 4
+// 8-bit channels (the last one is alpha for 2 and 4 channels). Each level is
+// half the size of the one above, rounded down but at least 1, tightly packed
+// in the source's row order. Returns false for unsupported input.
+bool buildMipChain(const unsigned char* pixels, int width, int height, int channels, const MipOptions& options,
+                   std::vector<std::vector<unsigned char>>& mips);
+
+const char* mipFilterName(MipFilter filter);
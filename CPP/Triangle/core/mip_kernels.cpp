@@ -0,0 +1,59 @@
+#include "mip_kernels.h"
+
+const MipKernels& getMipKernels(SimdLevel level) {
+#ifdef TRIANGLE_X86_KERNELS
+    if (level >= SimdLevel::AVX2) {
+        return mipKernelsAvx2;
+    }
+    if (level >= SimdLevel::SSE41) {
+        return mipKernelsSse41;
+    }
+#else
+    (void)level;
+#endif
+    return mipKernelsScalar;
+}
+
+static void boxRowScalar(const float* row0, const float* row1, int inWidth, float* out, int outWidth) {
+    int step = inWidth > 1 ? 4 : 0;
+    for (int x = 0; x < outWidth; x++) {
+        const float* a = row0 + x * 8;
+        const float* b = row1 + x * 8;
+        for (int c = 0; c < 4; c++) {
+            out[x * 4 + c] = ((a[c] + a[c + step]) + (b[c] + b[c + step])) * 0.25f;
+        }
+    }
+}
+
+static void horizontalRowScalar(const float* in, const float* weights, int taps, float* out, int outWidth) {
+    for (int x = 0; x < outWidth; x++) {
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const float* source = in + x * 8;
+        for (int k = 0; k < taps; k++) {
+            for (int c = 0; c < 4; c++) {
+                sum[c] += weights[k] * source[k * 4 + c];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            out[x * 4 + c] = sum[c];
+        }
+    }
+}
+
+static void verticalRowScalar(const float* const* rows, const float* weights, int taps, float* out, int count) {
+    for (int i = 0; i < count; i++) {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        out[i] = sum < 0.0f ? 0.0f : sum > 1.0f ? 1.0f : sum;
+    }
+}
+
+static void toUnorm8Scalar(const float* in, unsigned char* out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = (unsigned char)(in[i] * 255.0f + 0.5f);
+    }
+}
+
+const MipKernels mipKernelsScalar = { boxRowScalar, horizontalRowScalar, verticalRowScalar, toUnorm8Scalar };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "softraster/cpu_features.h"
+
+// Inner loops of the mip builder (mip_builder.cpp). Pixels are 4 floats
+// (linear RGBA); counts are in pixels unless noted.
+struct MipKernels {
+    // out[x] = average of in rows 0 and 1 at columns 2x and 2x+1 (2x alone
+    // when inWidth is 1)
+    void (*boxRow)(const float* row0, const float* row1, int inWidth, float* out, int outWidth);
+    // out[x] = sum of weights[k] * in[2x + k]; in is padded so all taps exist
+    void (*horizontalRow)(const float* in, const float* weights, int taps, float* out, int outWidth);
+    // out[i] = clamp(sum of weights[k] * rows[k][i], 0, 1), over count floats
+    void (*verticalRow)(const float* const* rows, const float* weights, int taps, float* out, int count);
+    // out[i] = round(in[i] * 255) for count floats already in [0, 1]
+    void (*toUnorm8)(const float* in, unsigned char* out, int count);
+};
+
+// Kernels for the given level, or for the best level below it that this build has
+const MipKernels& getMipKernels(SimdLevel level);
+
+extern const MipKernels mipKernelsScalar;
+#ifdef TRIANGLE_X86_KERNELS
+// Defined in translation units built with -msse4.1 and -mavx2 -mfma; only
+// use them after checking detectSimdLevel()
+extern const MipKernels mipKernelsSse41;
+extern const MipKernels mipKernelsAvx2;
+#endif
@@ -0,0 +1,101 @@
+// Built with -mavx2 -mfma; only reached through getMipKernels()
+#include "mip_kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+inline __m256 loadPixelPair(const float* low, const float* high) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+// Two output pixels per register: input pixels 0-3 load as [0 1] and [2 3],
+// and regrouping the halves into [0 2] + [1 3] sums the horizontal pairs
+void boxRow(const float* row0, const float* row1, int inWidth, float* out, int outWidth) {
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    int x = 0;
+    if (inWidth > 1) {
+        for (; x + 2 <= outWidth; x += 2) {
+            __m256 a0 = _mm256_loadu_ps(row0 + x * 8);
+            __m256 a1 = _mm256_loadu_ps(row0 + x * 8 + 8);
+            __m256 b0 = _mm256_loadu_ps(row1 + x * 8);
+            __m256 b1 = _mm256_loadu_ps(row1 + x * 8 + 8);
+            __m256 top = _mm256_add_ps(_mm256_permute2f128_ps(a0, a1, 0x20), _mm256_permute2f128_ps(a0, a1, 0x31));
+            __m256 bottom = _mm256_add_ps(_mm256_permute2f128_ps(b0, b1, 0x20), _mm256_permute2f128_ps(b0, b1, 0x31));
+            _mm256_storeu_ps(out + x * 4, _mm256_mul_ps(_mm256_add_ps(top, bottom), quarter));
+        }
+    }
+    int step = inWidth > 1 ? 4 : 0;
+    for (; x < outWidth; x++) {
+        const float* a = row0 + x * 8;
+        const float* b = row1 + x * 8;
+        __m128 top = _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(a + step));
+        __m128 bottom = _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(b + step));
+        _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(top, bottom), _mm_set1_ps(0.25f)));
+    }
+}
+
+// Two output pixels per register; their taps start 2 pixels (8 floats) apart
+void horizontalRow(const float* in, const float* weights, int taps, float* out, int outWidth) {
+    int x = 0;
+    for (; x + 2 <= outWidth; x += 2) {
+        const float* source = in + x * 8;
+        __m256 sum = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(weights[k]), loadPixelPair(source + k * 4, source + k * 4 + 8), sum);
+        }
+        _mm256_storeu_ps(out + x * 4, sum);
+    }
+    for (; x < outWidth; x++) {
+        const float* source = in + x * 8;
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm_fmadd_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(source + k * 4), sum);
+        }
+        _mm_storeu_ps(out + x * 4, sum);
+    }
+}
+
+void verticalRow(const float* const* rows, const float* weights, int taps, float* out, int count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i), sum);
+        }
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(sum, zero), one));
+    }
+    for (; i < count; i++) {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        out[i] = sum < 0.0f ? 0.0f : sum > 1.0f ? 1.0f : sum;
+    }
+}
+
+// 32 values per iteration. The packs work within 128-bit lanes, so the
+// 4-byte groups come out as a0 b0 c0 d0 a1 b1 c1 d1 and are put back in order.
+void toUnorm8(const float* in, unsigned char* out, int count) {
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_loadu_ps(in + i), scale, half));
+        __m256i b = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_loadu_ps(in + i + 8), scale, half));
+        __m256i c = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_loadu_ps(in + i + 16), scale, half));
+        __m256i d = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_loadu_ps(in + i + 24), scale, half));
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    for (; i < count; i++) {
+        out[i] = (unsigned char)(in[i] * 255.0f + 0.5f);
+    }
+}
+
+}
+
+const MipKernels mipKernelsAvx2 = { boxRow, horizontalRow, verticalRow, toUnorm8 };
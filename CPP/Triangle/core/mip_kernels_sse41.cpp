@@ -0,0 +1,72 @@
+// Built with -msse4.1; only reached through getMipKernels()
+#include "mip_kernels.h"
+
+#include <smmintrin.h>
+
+namespace {
+
+// One pixel per register
+void boxRow(const float* row0, const float* row1, int inWidth, float* out, int outWidth) {
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    int step = inWidth > 1 ? 4 : 0;
+    for (int x = 0; x < outWidth; x++) {
+        const float* a = row0 + x * 8;
+        const float* b = row1 + x * 8;
+        __m128 top = _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(a + step));
+        __m128 bottom = _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(b + step));
+        _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+    }
+}
+
+void horizontalRow(const float* in, const float* weights, int taps, float* out, int outWidth) {
+    for (int x = 0; x < outWidth; x++) {
+        const float* source = in + x * 8;
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(source + k * 4)));
+        }
+        _mm_storeu_ps(out + x * 4, sum);
+    }
+}
+
+void verticalRow(const float* const* rows, const float* weights, int taps, float* out, int count) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+        }
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(sum, zero), one));
+    }
+    for (; i < count; i++) {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        out[i] = sum < 0.0f ? 0.0f : sum > 1.0f ? 1.0f : sum;
+    }
+}
+
+// 16 values per iteration: scale and round, then narrow 32 -> 16 -> 8 bits
+void toUnorm8(const float* in, unsigned char* out, int count) {
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), half));
+        __m128i b = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), half));
+        __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 8), scale), half));
+        __m128i d = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 12), scale), half));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i*)(out + i), packed);
+    }
+    for (; i < count; i++) {
+        out[i] = (unsigned char)(in[i] * 255.0f + 0.5f);
+    }
+}
+
+}
+
+const MipKernels mipKernelsSse41 = { boxRow, horizontalRow, verticalRow, toUnorm8 };
@@ -0,0 +1,622 @@
+#include "png_decoder.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "png_kernels.h"
+#include "upload_kernels.h"
+
+namespace {
+
+// ---- inflate (RFC 1950/1951) ----
+
+const int kFastBits = 10;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM64)
+const bool kLittleEndian = true;
+#else
+const bool kLittleEndian = false;
+#endif
+
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                     7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+int reverseBits(int value, int bits) {
+    int result = 0;
+    for (int i = 0; i < bits; i++) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+// Canonical Huffman code. Codes up to kFastBits long resolve with one table
+// lookup of the next input bits ((length << 9) | symbol; 0 = longer code);
+// longer ones are found by comparing against the last code of each length.
+struct Huffman {
+    uint16_t fast[1 << kFastBits];
+    uint16_t firstCode[16];
+    uint16_t firstSymbol[16];
+    int maxCode[17];
+    uint8_t sizes[288];
+    uint16_t symbols[288];
+
+    bool build(const uint8_t* lengths, int count) {
+        int sizeCount[16] = {};
+        std::memset(fast, 0, sizeof(fast));
+        for (int i = 0; i < count; i++) {
+            sizeCount[lengths[i]]++;
+        }
+        sizeCount[0] = 0;
+
+        int nextCode[16];
+        int code = 0, symbol = 0;
+        for (int length = 1; length < 16; length++) {
+            nextCode[length] = code;
+            firstCode[length] = (uint16_t)code;
+            firstSymbol[length] = (uint16_t)symbol;
+            code += sizeCount[length];
+            // Over-subscribed: more codes of this length than fit
+            if (sizeCount[length] && code - 1 >= (1 << length)) {
+                return false;
+            }
+            maxCode[length] = code << (16 - length);
+            code <<= 1;
+            symbol += sizeCount[length];
+        }
+        maxCode[16] = 0x10000;
+
+        for (int i = 0; i < count; i++) {
+            int length = lengths[i];
+            if (!length) {
+                continue;
+            }
+            int index = nextCode[length] - firstCode[length] + firstSymbol[length];
+            sizes[index] = (uint8_t)length;
+            symbols[index] = (uint16_t)i;
+            if (length <= kFastBits) {
+                for (int j = reverseBits(nextCode[length], length); j < (1 << kFastBits); j += 1 << length) {
+                    fast[j] = (uint16_t)((length << 9) | i);
+                }
+            }
+            nextCode[length]++;
+        }
+        return true;
+    }
+};
+
+struct FixedCodes {
+    Huffman literals, distances;
+
+    FixedCodes() {
+        uint8_t lengths[288];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        literals.build(lengths, 288);
+        std::fill(lengths, lengths + 30, 5);
+        distances.build(lengths, 30);
+    }
+};
+
+// Decodes a zlib stream into a buffer of known size. `report` is called with
+// the bytes written so far every kReportBytes or so, and once at the end.
+// Matches read earlier output, so nothing may write to the buffer meanwhile.
+class Inflater {
+private:
+    static const size_t kReportBytes = 64 * 1024;
+
+    const unsigned char* in;
+    size_t inSize;
+    size_t inPos;
+    uint64_t bits;
+    int bitCount;
+    unsigned char* out;
+    size_t outSize;
+    size_t outPos;
+    const std::function<void(size_t)>& report;
+
+    // Tops the bit buffer up to at least 57 bits: enough for a length and a
+    // distance code with their extra bits. Past the end of the input it reads
+    // zeros, which a valid stream never gets to use.
+    void refill() {
+        // Eight bytes at once where the input allows (little-endian hosts)
+        if (kLittleEndian && inPos + 8 <= inSize) {
+            uint64_t word;
+            std::memcpy(&word, in + inPos, 8);
+            bits |= word << bitCount;
+            inPos += (63 - bitCount) >> 3;
+            bitCount |= 56;
+            return;
+        }
+        while (bitCount <= 56) {
+            uint64_t byte = inPos < inSize ? in[inPos] : 0;
+            inPos++;
+            bits |= byte << bitCount;
+            bitCount += 8;
+        }
+    }
+
+    int take(int count) {
+        int value = (int)(bits & ((1u << count) - 1));
+        bits >>= count;
+        bitCount -= count;
+        return value;
+    }
+
+    // Negative for an invalid code
+    int decode(const Huffman& code) {
+        int entry = code.fast[bits & ((1 << kFastBits) - 1)];
+        if (entry) {
+            take(entry >> 9);
+            return entry & 511;
+        }
+        int reversed = reverseBits((int)(bits & 0xffff), 16);
+        int length = kFastBits + 1;
+        while (reversed >= code.maxCode[length]) {
+            length++;
+        }
+        if (length >= 16) {
+            return -1;
+        }
+        int index = (reversed >> (16 - length)) - code.firstCode[length] + code.firstSymbol[length];
+        if (index >= 288 || code.sizes[index] != length) {
+            return -1;
+        }
+        take(length);
+        return code.symbols[index];
+    }
+
+    bool readDynamicCodes(Huffman& literals, Huffman& distances) {
+        static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        refill();
+        int literalCount = take(5) + 257;
+        int distanceCount = take(5) + 1;
+        int lengthCodeCount = take(4) + 4;
+        if (literalCount > 286 || distanceCount > 30) {
+            return false;
+        }
+
+        uint8_t codeLengths[19] = {};
+        for (int i = 0; i < lengthCodeCount; i++) {
+            refill();
+            codeLengths[order[i]] = (uint8_t)take(3);
+        }
+        Huffman lengthCode;
+        if (!lengthCode.build(codeLengths, 19)) {
+            return false;
+        }
+
+        uint8_t lengths[286 + 30];
+        int total = literalCount + distanceCount;
+        for (int n = 0; n < total;) {
+            refill();
+            int symbol = decode(lengthCode);
+            if (symbol < 0) {
+                return false;
+            }
+            if (symbol < 16) {
+                lengths[n++] = (uint8_t)symbol;
+                continue;
+            }
+            int repeat;
+            uint8_t value = 0;
+            if (symbol == 16) {
+                if (n == 0) {
+                    return false;
+                }
+                repeat = 3 + take(2);
+                value = lengths[n - 1];
+            } else if (symbol == 17) {
+                repeat = 3 + take(3);
+            } else {
+                repeat = 11 + take(7);
+            }
+            if (n + repeat > total) {
+                return false;
+            }
+            std::memset(lengths + n, value, repeat);
+            n += repeat;
+        }
+        return literals.build(lengths, literalCount) && distances.build(lengths + literalCount, distanceCount);
+    }
+
+    bool inflateBlock(const Huffman& literals, const Huffman& distances) {
+        size_t nextReport = outPos + kReportBytes;
+        for (;;) {
+            refill();
+            int symbol = decode(literals);
+            if (symbol < 256) {
+                if (symbol < 0 || outPos >= outSize) {
+                    return false;
+                }
+                out[outPos++] = (unsigned char)symbol;
+                continue;
+            }
+            if (symbol == 256) {
+                return true;
+            }
+
+            symbol -= 257;
+            if (symbol >= 29) {
+                return false;
+            }
+            size_t length = kLengthBase[symbol] + take(kLengthExtra[symbol]);
+            int distanceSymbol = decode(distances);
+            if (distanceSymbol < 0 || distanceSymbol >= 30) {
+                return false;
+            }
+            size_t distance = kDistanceBase[distanceSymbol] + take(kDistanceExtra[distanceSymbol]);
+            if (distance > outPos || length > outSize - outPos) {
+                return false;
+            }
+
+            unsigned char* target = out + outPos;
+            const unsigned char* source = target - distance;
+            if (distance >= 8 && length + 8 <= outSize - outPos) {
+                // Eight bytes at a time, overshooting into space written later;
+                // each copy reads only bytes at least eight back
+                for (size_t i = 0; i < length; i += 8) {
+                    std::memcpy(target + i, source + i, 8);
+                }
+            } else if (distance == 1) {
+                std::memset(target, *source, length);
+            } else {
+                for (size_t i = 0; i < length; i++) {
+                    target[i] = source[i];
+                }
+            }
+            outPos += length;
+
+            if (outPos >= nextReport) {
+                report(outPos);
+                nextReport = outPos + kReportBytes;
+            }
+        }
+    }
+
+    bool copyStoredBlock() {
+        // Drop the bits up to the byte boundary; whole bytes still buffered
+        // are handed back to the input
+        take(bitCount & 7);
+        inPos -= bitCount / 8;
+        bits = 0;
+        bitCount = 0;
+        if (inPos + 4 > inSize) {
+            return false;
+        }
+        size_t length = in[inPos] | (in[inPos + 1] << 8);
+        size_t inverse = in[inPos + 2] | (in[inPos + 3] << 8);
+        inPos += 4;
+        if ((length ^ 0xffff) != inverse || length > inSize - inPos || length > outSize - outPos) {
+            return false;
+        }
+        std::memcpy(out + outPos, in + inPos, length);
+        inPos += length;
+        outPos += length;
+        report(outPos);
+        return true;
+    }
+
+public:
+    Inflater(const unsigned char* in, size_t inSize, unsigned char* out, size_t outSize,
+             const std::function<void(size_t)>& report)
+        : in(in), inSize(inSize), inPos(0), bits(0), bitCount(0), out(out), outSize(outSize), outPos(0), report(report) {}
+
+    // True if the stream is valid and filled the whole buffer
+    bool run() {
+        if (inSize < 2) {
+            return false;
+        }
+        // zlib header: deflate, no preset dictionary, valid check bits
+        int method = in[0], flags = in[1];
+        if ((method & 15) != 8 || (flags & 32) || (method * 256 + flags) % 31 != 0) {
+            return false;
+        }
+        inPos = 2;
+
+        static const FixedCodes fixed;
+        bool last = false;
+        while (!last) {
+            // Reading well past the end means a missing final block
+            if (inPos > inSize + 8) {
+                return false;
+            }
+            refill();
+            last = take(1) != 0;
+            int type = take(2);
+            bool ok;
+            if (type == 0) {
+                ok = copyStoredBlock();
+            } else if (type == 1) {
+                ok = inflateBlock(fixed.literals, fixed.distances);
+            } else if (type == 2) {
+                Huffman literals, distances;
+                ok = readDynamicCodes(literals, distances) && inflateBlock(literals, distances);
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        report(outPos);
+        return outPos == outSize;
+    }
+};
+
+// ---- PNG ----
+
+uint32_t readBigEndian(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+struct PngInfo {
+    int width = 0, height = 0;
+    int colorType = 0;
+    int fileChannels = 0;       // what stbi reports: palette images count as 3 or 4
+    int rowChannels = 0;        // bytes per pixel in the filtered rows
+    uint8_t palette[256][4] = {};
+    bool hasPalette = false;
+    std::vector<std::pair<const unsigned char*, size_t>> idat;
+};
+
+// Reads the chunks this decoder needs; false for anything it does not handle
+bool parsePng(const unsigned char* data, size_t size, PngInfo& info) {
+    size_t pos = 8;
+    bool first = true;
+    for (;;) {
+        if (pos + 12 > size) {
+            return false;
+        }
+        uint32_t length = readBigEndian(data + pos);
+        const unsigned char* type = data + pos + 4;
+        const unsigned char* body = data + pos + 8;
+        if (length > size - pos - 12) {
+            return false;
+        }
+        pos += 12 + (size_t)length;
+
+        if (first) {
+            if (std::memcmp(type, "IHDR", 4) != 0 || length != 13) {
+                return false;
+            }
+            first = false;
+            uint32_t width = readBigEndian(body), height = readBigEndian(body + 4);
+            int depth = body[8], colorType = body[9];
+            // Same dimension limit as stb_image
+            if (width == 0 || height == 0 || width > (1u << 24) || height > (1u << 24)) {
+                return false;
+            }
+            // Compression, filter method and interlacing must all be 0
+            if (depth != 8 || body[10] != 0 || body[11] != 0 || body[12] != 0) {
+                return false;
+            }
+            static const int channelsByType[7] = { 1, 0, 3, 1, 2, 0, 4 };
+            if (colorType > 6 || channelsByType[colorType] == 0) {
+                return false;
+            }
+            info.width = (int)width;
+            info.height = (int)height;
+            info.colorType = colorType;
+            info.rowChannels = channelsByType[colorType];
+            info.fileChannels = colorType == 3 ? 3 : info.rowChannels;
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            if (length % 3 != 0 || length > 256 * 3) {
+                return false;
+            }
+            for (uint32_t i = 0; i < length / 3; i++) {
+                info.palette[i][0] = body[i * 3];
+                info.palette[i][1] = body[i * 3 + 1];
+                info.palette[i][2] = body[i * 3 + 2];
+                info.palette[i][3] = 255;
+            }
+            info.hasPalette = true;
+        } else if (std::memcmp(type, "tRNS", 4) == 0) {
+            // A palette's alpha is supported; colour keys are left to stb_image
+            if (info.colorType != 3 || !info.hasPalette || length > 256) {
+                return false;
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                info.palette[i][3] = body[i];
+            }
+            info.fileChannels = 4;
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            info.idat.emplace_back(body, (size_t)length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        } else if (std::memcmp(type, "CgBI", 4) == 0) {
+            return false;
+        } else if (!(type[0] & 32)) {
+            // Unknown critical chunk
+            return false;
+        }
+    }
+    return !info.idat.empty() && (info.colorType != 3 || info.hasPalette);
+}
+
+// One unfiltered row to the output layout. Grey is (r*77 + g*150 + b*29) >> 8
+// and missing alpha is 255, as in stb_image.
+void convertRow(const PngInfo& info, const unsigned char* in, unsigned char* out, int outChannels) {
+    int width = info.width;
+    int inChannels = info.rowChannels;
+    if (info.colorType != 3 && inChannels == outChannels) {
+        std::memcpy(out, in, (size_t)width * inChannels);
+        return;
+    }
+    if (info.colorType != 3 && inChannels == 3 && outChannels == 4) {
+        static const ExpandRgbKernel expandRgb = getExpandRgbKernel(detectSimdLevel());
+        expandRgb(in, out, (size_t)width);
+        return;
+    }
+
+    for (int x = 0; x < width; x++) {
+        int r, g, b, a = 255;
+        bool colour;
+        if (info.colorType == 3) {
+            const uint8_t* entry = info.palette[in[x]];
+            r = entry[0], g = entry[1], b = entry[2], a = entry[3];
+            colour = true;
+        } else {
+            const unsigned char* p = in + (size_t)x * inChannels;
+            colour = inChannels >= 3;
+            r = p[0];
+            g = colour ? p[1] : r;
+            b = colour ? p[2] : r;
+            if (inChannels == 2 || inChannels == 4) {
+                a = p[inChannels - 1];
+            }
+        }
+        unsigned char* q = out + (size_t)x * outChannels;
+        if (outChannels <= 2) {
+            q[0] = (unsigned char)(colour ? (r * 77 + g * 150 + b * 29) >> 8 : r);
+            if (outChannels == 2) {
+                q[1] = (unsigned char)a;
+            }
+        } else {
+            q[0] = (unsigned char)r;
+            q[1] = (unsigned char)g;
+            q[2] = (unsigned char)b;
+            if (outChannels == 4) {
+                q[3] = (unsigned char)a;
+            }
+        }
+    }
+}
+
+// Rows handed from the inflate thread to the unfiltering one
+struct RowProgress {
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t produced = 0;
+    bool done = false;
+};
+
+}  // namespace
+
+bool isPng(const unsigned char* data, size_t size) {
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    return size >= 8 && std::memcmp(data, signature, 8) == 0;
+}
+
+unsigned char* decodePng(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                         int desiredChannels, const PngDecodeOptions& options) {
+    PngInfo info;
+    if (desiredChannels < 0 || desiredChannels > 4 || !isPng(data, size) || !parsePng(data, size, info)) {
+        return nullptr;
+    }
+
+    int outChannels = desiredChannels ? desiredChannels : info.fileChannels;
+    size_t rowBytes = (size_t)info.width * info.rowChannels;
+    size_t filteredSize = (rowBytes + 1) * info.height;
+    size_t outRowBytes = (size_t)info.width * outChannels;
+    // stb_image's limit: sizes must fit an int
+    if (filteredSize > 0x7fffffff || outRowBytes * info.height > 0x7fffffff) {
+        return nullptr;
+    }
+
+    // The compressed stream is split across IDAT chunks; join them unless there is one
+    std::vector<unsigned char> joined;
+    const unsigned char* compressed = info.idat[0].first;
+    size_t compressedSize = info.idat[0].second;
+    if (info.idat.size() > 1) {
+        for (const auto& chunk : info.idat) {
+            joined.insert(joined.end(), chunk.first, chunk.first + chunk.second);
+        }
+        compressed = joined.data();
+        compressedSize = joined.size();
+    }
+
+    // Every byte is written by the inflate before it is read
+    std::unique_ptr<unsigned char[]> filtered(new unsigned char[filteredSize]);
+    unsigned char* pixels = (unsigned char*)std::malloc(outRowBytes * info.height);
+    if (!pixels) {
+        return nullptr;
+    }
+
+    bool pipelined = options.threads == 2 ||
+                     (options.threads == 0 && filteredSize >= (4u << 20) && std::thread::hardware_concurrency() > 1);
+    RowProgress progress;
+    bool inflated = false;
+    std::thread inflateThread;
+    if (pipelined) {
+        inflateThread = std::thread([&] {
+            std::function<void(size_t)> report = [&](size_t produced) {
+                std::lock_guard<std::mutex> lock(progress.mutex);
+                progress.produced = produced;
+                progress.condition.notify_one();
+            };
+            bool ok = Inflater(compressed, compressedSize, filtered.get(), filteredSize, report).run();
+            std::lock_guard<std::mutex> lock(progress.mutex);
+            inflated = ok;
+            progress.done = true;
+            progress.condition.notify_one();
+        });
+    } else {
+        std::function<void(size_t)> report = [](size_t) {};
+        inflated = Inflater(compressed, compressedSize, filtered.get(), filteredSize, report).run();
+        progress.produced = filteredSize;
+        progress.done = true;
+        if (!inflated) {
+            std::free(pixels);
+            return nullptr;
+        }
+    }
+
+    // Rows are unfiltered into the output when no conversion follows, otherwise
+    // through two scratch rows. The inflate buffer is never written: matches
+    // still being decoded read from it.
+    bool direct = info.colorType != 3 && outChannels == info.rowChannels;
+    std::vector<unsigned char> scratch(direct ? 0 : rowBytes * 2);
+    std::vector<unsigned char> zeros(rowBytes, 0);
+    const unsigned char* prior = zeros.data();
+    static const UnfilterRowKernel unfilterRow = getUnfilterRowKernel(detectSimdLevel());
+    size_t available = 0;
+    bool ok = true;
+    for (int y = 0; y < info.height && ok; y++) {
+        size_t rowEnd = (rowBytes + 1) * (y + 1);
+        if (available < rowEnd) {
+            std::unique_lock<std::mutex> lock(progress.mutex);
+            progress.condition.wait(lock, [&] { return progress.produced >= rowEnd || progress.done; });
+            available = progress.produced;
+            if (available < rowEnd) {
+                ok = false;
+                break;
+            }
+        }
+
+        const unsigned char* in = filtered.get() + (rowBytes + 1) * y;
+        int outRow = options.flipVertically ? info.height - 1 - y : y;
+        unsigned char* outRowData = pixels + outRowBytes * outRow;
+        unsigned char* row = direct ? outRowData : scratch.data() + rowBytes * (y & 1);
+        ok = unfilterRow(in[0], in + 1, prior, row, rowBytes, info.rowChannels);
+        if (ok && !direct) {
+            convertRow(info, row, outRowData, outChannels);
+        }
+        prior = row;
+    }
+
+    if (inflateThread.joinable()) {
+        inflateThread.join();
+    }
+    if (!ok || !inflated) {
+        std::free(pixels);
+        return nullptr;
+    }
+    width = info.width;
+    height = info.height;
+    channels = info.fileChannels;
+    return pixels;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+// PNG decoder for the common case, 8-bit non-interlaced grey, grey + alpha,
+// RGB, RGBA and palette images, that overlaps inflate with unfiltering.
+//
+// zlib inflate is serial, and so is PNG unfiltering (each row depends on the
+// one above), but they are serial in different places: for large images the
+// inflate runs on a second thread and the calling thread unfilters, converts
+// and flips each row as soon as it is complete. Small images and machines
+// with one hardware thread run both steps on the calling thread.
+//
+// Results match stbi_load_from_memory() for the same file, with the same
+// `channels` (the file's channel count) and conversion to `desiredChannels`.
+
+struct PngDecodeOptions {
+    bool flipVertically = false;
+    int threads = 0;    // 0 = pipelined when worth it, 1 = calling thread only, 2 = always pipelined
+};
+
+// Returns pixels allocated with malloc() (free with stbi_image_free()). Null
+// for anything outside the subset above (16-bit or low bit depths,
+// interlacing, tRNS colour keys on non-palette images, Apple's CgBI variant)
+// and for corrupt files: callers fall back to stb_image, which decodes the
+// rest and reports the errors.
+unsigned char* decodePng(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                         int desiredChannels, const PngDecodeOptions& options = PngDecodeOptions());
+
+// Whether the data starts with the PNG signature
+bool isPng(const unsigned char* data, size_t size);
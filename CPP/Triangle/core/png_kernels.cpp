@@ -0,0 +1,89 @@
+#include "png_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+UnfilterRowKernel getUnfilterRowKernel(SimdLevel level) {
+#ifdef TRIANGLE_X86_KERNELS
+    if (level >= SimdLevel::SSE41) {
+        return unfilterRowSse41;
+    }
+#else
+    (void)level;
+#endif
+    return unfilterRowScalar;
+}
+
+// Predictor choice as in the PNG spec, with ties going to a, then b, written
+// so the compiler can use conditional moves
+static inline int paeth(int a, int b, int c) {
+    int pa = std::abs(b - c);
+    int pb = std::abs(a - c);
+    int pc = std::abs(a + b - 2 * c);
+    if (pb < pa) {
+        pa = pb;
+        a = b;
+    }
+    return pc < pa ? c : a;
+}
+
+// Bpp is a template argument so the channels of a pixel unroll into
+// independent chains
+template <int Bpp>
+static bool unfilter(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out,
+                     size_t rowBytes) {
+    switch (filter) {
+    case 0:
+        std::memcpy(out, in, rowBytes);
+        return true;
+    case 1:
+        std::memcpy(out, in, Bpp);
+        for (size_t i = Bpp; i < rowBytes; i += Bpp) {
+            for (int k = 0; k < Bpp; k++) {
+                out[i + k] = (unsigned char)(in[i + k] + out[i + k - Bpp]);
+            }
+        }
+        return true;
+    case 2:
+        for (size_t i = 0; i < rowBytes; i++) {
+            out[i] = (unsigned char)(in[i] + prior[i]);
+        }
+        return true;
+    case 3:
+        for (int k = 0; k < Bpp; k++) {
+            out[k] = (unsigned char)(in[k] + (prior[k] >> 1));
+        }
+        for (size_t i = Bpp; i < rowBytes; i += Bpp) {
+            for (int k = 0; k < Bpp; k++) {
+                out[i + k] = (unsigned char)(in[i + k] + ((out[i + k - Bpp] + prior[i + k]) >> 1));
+            }
+        }
+        return true;
+    case 4:
+        for (int k = 0; k < Bpp; k++) {
+            out[k] = (unsigned char)(in[k] + prior[k]);
+        }
+        for (size_t i = Bpp; i < rowBytes; i += Bpp) {
+            for (int k = 0; k < Bpp; k++) {
+                out[i + k] = (unsigned char)(in[i + k] + paeth(out[i + k - Bpp], prior[i + k], prior[i + k - Bpp]));
+            }
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool unfilterRowScalar(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out,
+                       size_t rowBytes, int bpp) {
+    switch (bpp) {
+    case 1:
+        return unfilter<1>(filter, in, prior, out, rowBytes);
+    case 2:
+        return unfilter<2>(filter, in, prior, out, rowBytes);
+    case 3:
+        return unfilter<3>(filter, in, prior, out, rowBytes);
+    default:
+        return unfilter<4>(filter, in, prior, out, rowBytes);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include "softraster/cpu_features.h"
+
+// Undoes one PNG row filter (png_decoder.cpp): in holds the filtered bytes,
+// prior the unfiltered row above (zeros for the first row), bpp the bytes
+// per pixel (1-4). False for an unknown filter type. Buffers must not overlap.
+using UnfilterRowKernel = bool (*)(int filter, const unsigned char* in, const unsigned char* prior,
+                                   unsigned char* out, size_t rowBytes, int bpp);
+
+// Kernel for the given level, or for the best level below it that this build
+// has. Each pixel depends on the one to its left, so wider vectors do not
+// help: SSE4.1 is the top level.
+UnfilterRowKernel getUnfilterRowKernel(SimdLevel level);
+
+bool unfilterRowScalar(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out,
+                       size_t rowBytes, int bpp);
+#ifdef TRIANGLE_X86_KERNELS
+// Defined in a translation unit built with -msse4.1; only call it after
+// checking detectSimdLevel()
+bool unfilterRowSse41(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out,
+                      size_t rowBytes, int bpp);
+#endif
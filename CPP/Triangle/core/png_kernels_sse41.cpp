@@ -0,0 +1,122 @@
+// Built with -msse4.1; only reached through getUnfilterRowKernel()
+#include "png_kernels.h"
+
+#include <cstring>
+#include <smmintrin.h>
+
+namespace {
+
+// One pixel of 3 or 4 bytes in the low lanes; the loads and stores never
+// touch bytes past the pixel
+template <int Bpp>
+inline __m128i loadPixel(const unsigned char* p) {
+    int value = 0;
+    std::memcpy(&value, p, Bpp);
+    return _mm_cvtsi32_si128(value);
+}
+
+template <int Bpp>
+inline void storePixel(unsigned char* p, __m128i pixel) {
+    int value = _mm_cvtsi128_si32(pixel);
+    std::memcpy(p, &value, Bpp);
+}
+
+// Sub, Avg and Paeth work a pixel at a time (each needs its left neighbour),
+// with all channels of the pixel in one register
+template <int Bpp>
+void unfilterSub(const unsigned char* in, unsigned char* out, size_t rowBytes) {
+    __m128i left = _mm_setzero_si128();
+    for (size_t i = 0; i < rowBytes; i += Bpp) {
+        left = _mm_add_epi8(loadPixel<Bpp>(in + i), left);
+        storePixel<Bpp>(out + i, left);
+    }
+}
+
+template <int Bpp>
+void unfilterAvg(const unsigned char* in, const unsigned char* prior, unsigned char* out, size_t rowBytes) {
+    // floor((left + above) / 2): _mm_avg_epu8 rounds up, so subtract the odd bit
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i left = _mm_setzero_si128();
+    for (size_t i = 0; i < rowBytes; i += Bpp) {
+        __m128i above = loadPixel<Bpp>(prior + i);
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(left, above), _mm_and_si128(_mm_xor_si128(left, above), one));
+        left = _mm_add_epi8(loadPixel<Bpp>(in + i), average);
+        storePixel<Bpp>(out + i, left);
+    }
+}
+
+template <int Bpp>
+void unfilterPaeth(const unsigned char* in, const unsigned char* prior, unsigned char* out, size_t rowBytes) {
+    // 16-bit lanes: a = left, b = above, c = above-left
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowByte = _mm_set1_epi16(0xff);
+    __m128i a = zero, c = zero;
+    for (size_t i = 0; i < rowBytes; i += Bpp) {
+        __m128i b = _mm_unpacklo_epi8(loadPixel<Bpp>(prior + i), zero);
+        __m128i residual = _mm_unpacklo_epi8(loadPixel<Bpp>(in + i), zero);
+        __m128i bc = _mm_sub_epi16(b, c);
+        __m128i ac = _mm_sub_epi16(a, c);
+        __m128i pa = _mm_abs_epi16(bc);
+        __m128i pb = _mm_abs_epi16(ac);
+        __m128i pc = _mm_abs_epi16(_mm_add_epi16(bc, ac));
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        // Ties go to a, then b
+        __m128i predictor = _mm_blendv_epi8(c, b, _mm_cmpeq_epi16(smallest, pb));
+        predictor = _mm_blendv_epi8(predictor, a, _mm_cmpeq_epi16(smallest, pa));
+        a = _mm_and_si128(_mm_add_epi16(predictor, residual), lowByte);
+        storePixel<Bpp>(out + i, _mm_packus_epi16(a, a));
+        c = b;
+    }
+}
+
+void unfilterUp(const unsigned char* in, const unsigned char* prior, unsigned char* out, size_t rowBytes) {
+    size_t i = 0;
+    for (; i + 16 <= rowBytes; i += 16) {
+        __m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(in + i)), _mm_loadu_si128((const __m128i*)(prior + i)));
+        _mm_storeu_si128((__m128i*)(out + i), sum);
+    }
+    for (; i < rowBytes; i++) {
+        out[i] = (unsigned char)(in[i] + prior[i]);
+    }
+}
+
+template <int Bpp>
+bool unfilter(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out, size_t rowBytes) {
+    switch (filter) {
+    case 0:
+        std::memcpy(out, in, rowBytes);
+        return true;
+    case 1:
+        unfilterSub<Bpp>(in, out, rowBytes);
+        return true;
+    case 2:
+        unfilterUp(in, prior, out, rowBytes);
+        return true;
+    case 3:
+        unfilterAvg<Bpp>(in, prior, out, rowBytes);
+        return true;
+    case 4:
+        unfilterPaeth<Bpp>(in, prior, out, rowBytes);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+bool unfilterRowSse41(int filter, const unsigned char* in, const unsigned char* prior, unsigned char* out,
+                      size_t rowBytes, int bpp) {
+    // Grey and grey + alpha pixels are too narrow to gain from vectors, except for Up
+    if (bpp == 3) {
+        return unfilter<3>(filter, in, prior, out, rowBytes);
+    }
+    if (bpp == 4) {
+        return unfilter<4>(filter, in, prior, out, rowBytes);
+    }
+    if (filter == 2) {
+        unfilterUp(in, prior, out, rowBytes);
+        return true;
+    }
+    return unfilterRowScalar(filter, in, prior, out, rowBytes, bpp);
+}
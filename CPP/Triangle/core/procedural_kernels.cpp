@@ -0,0 +1,111 @@
+#include "procedural_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+const ProceduralKernels& getProceduralKernels(SimdLevel level) {
+#ifdef TRIANGLE_X86_KERNELS
+    if (level >= SimdLevel::AVX2) {
+        return proceduralKernelsAvx2;
+    }
+#else
+    (void)level;
+#endif
+    return proceduralKernelsScalar;
+}
+
+// Quintic fade, so the noise has continuous second derivatives across cells
+static inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+// Top 24 bits of the hash as a float in [0, 1)
+static inline float latticeValue(uint32_t h) {
+    return (float)(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// One of 8 gradients, (+-1, +-2) and (+-2, +-1), dotted with (x, y)
+static inline float latticeGradient(uint32_t h, float x, float y) {
+    float u = (h & 4) ? y : x;
+    float v = (h & 4) ? x : y;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+}
+
+// Cell of a lattice coordinate and the one after it, wrapped to the period
+struct LatticeCell {
+    int cell;
+    int next;
+    float fraction;
+};
+
+static inline LatticeCell latticeCell(float coordinate, int period) {
+    LatticeCell result;
+    float floored = std::floor(coordinate);
+    result.cell = (int)floored;
+    result.fraction = coordinate - floored;
+    if (result.cell >= period) {
+        result.cell -= period;
+    }
+    result.next = result.cell + 1 == period ? 0 : result.cell + 1;
+    return result;
+}
+
+static void valueNoiseRowScalar(const NoiseRow& row, float* out, int count) {
+    LatticeCell cy = latticeCell(row.y, row.periodY);
+    uint32_t row0 = hashLatticeRow((uint32_t)cy.cell, row.seed);
+    uint32_t row1 = hashLatticeRow((uint32_t)cy.next, row.seed);
+    float sy = fade(cy.fraction);
+    for (int i = 0; i < count; i++) {
+        LatticeCell cx = latticeCell(row.x0 + (float)i * row.dx, row.periodX);
+        float sx = fade(cx.fraction);
+        float top = lerp(latticeValue(hashLattice((uint32_t)cx.cell, row0)), latticeValue(hashLattice((uint32_t)cx.next, row0)), sx);
+        float bottom = lerp(latticeValue(hashLattice((uint32_t)cx.cell, row1)), latticeValue(hashLattice((uint32_t)cx.next, row1)), sx);
+        out[i] += row.amplitude * lerp(top, bottom, sy);
+    }
+}
+
+static void perlinNoiseRowScalar(const NoiseRow& row, float* out, int count) {
+    LatticeCell cy = latticeCell(row.y, row.periodY);
+    uint32_t row0 = hashLatticeRow((uint32_t)cy.cell, row.seed);
+    uint32_t row1 = hashLatticeRow((uint32_t)cy.next, row.seed);
+    float fy = cy.fraction;
+    float sy = fade(fy);
+    for (int i = 0; i < count; i++) {
+        LatticeCell cx = latticeCell(row.x0 + (float)i * row.dx, row.periodX);
+        float fx = cx.fraction;
+        float sx = fade(fx);
+        float top = lerp(latticeGradient(hashLattice((uint32_t)cx.cell, row0), fx, fy),
+                         latticeGradient(hashLattice((uint32_t)cx.next, row0), fx - 1.0f, fy), sx);
+        float bottom = lerp(latticeGradient(hashLattice((uint32_t)cx.cell, row1), fx, fy - 1.0f),
+                            latticeGradient(hashLattice((uint32_t)cx.next, row1), fx - 1.0f, fy - 1.0f), sx);
+        // The gradients are sqrt(5) long; this brings the result to about [-1, 1]
+        out[i] += row.amplitude * (0.507f * lerp(top, bottom, sy));
+    }
+}
+
+static void radialRowScalar(float x0, float dx, float y, float* out, int count) {
+    for (int i = 0; i < count; i++) {
+        float x = x0 + (float)i * dx;
+        out[i] = std::sqrt(x * x + y * y);
+    }
+}
+
+static void shadeRowScalar(const float* t, const float* color0, const float* color1, unsigned char* out, int count) {
+    for (int i = 0; i < count; i++) {
+        float s = std::min(std::max(t[i], 0.0f), 1.0f);
+        for (int c = 0; c < 4; c++) {
+            out[i * 4 + c] = (unsigned char)(color0[c] + (color1[c] - color0[c]) * s + 0.5f);
+        }
+    }
+}
+
+const ProceduralKernels proceduralKernelsScalar = {
+    valueNoiseRowScalar,
+    perlinNoiseRowScalar,
+    radialRowScalar,
+    shadeRowScalar,
+};
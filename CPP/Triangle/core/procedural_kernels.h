@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include "softraster/cpu_features.h"
+
+// One octave of 2D lattice noise along a row of texels. Texel i sits at
+// lattice coordinate (x0 + i * dx, y), and the lattice wraps after periodX
+// by periodY cells, so the noise tiles. Coordinates must lie in
+// [0, periodX] x [0, periodY].
+struct NoiseRow {
+    float x0;
+    float dx;
+    float y;
+    int periodX;
+    int periodY;
+    uint32_t seed;
+    float amplitude;
+};
+
+// Inner loops of the procedural texture generator (procedural_texture.cpp).
+// Rows are first computed as a blend factor t per texel, then shaded.
+struct ProceduralKernels {
+    // out[i] += amplitude * value noise in [0, 1]
+    void (*valueNoiseRow)(const NoiseRow& row, float* out, int count);
+    // out[i] += amplitude * gradient (Perlin) noise in about [-1, 1]
+    void (*perlinNoiseRow)(const NoiseRow& row, float* out, int count);
+    // out[i] = distance of (x0 + i * dx, y) from the origin
+    void (*radialRow)(float x0, float dx, float y, float* out, int count);
+    // RGBA8 out[i] = round(color0 + (color1 - color0) * clamp(t[i], 0, 1)), with
+    // the colours in 0-255
+    void (*shadeRow)(const float* t, const float* color0, const float* color1, unsigned char* out, int count);
+};
+
+// Kernels for the given level, or for the best level below it that this build has
+const ProceduralKernels& getProceduralKernels(SimdLevel level);
+
+// Lattice hash shared by all kernel levels, so they generate the same noise
+inline uint32_t hashLattice(uint32_t x, uint32_t yHash) {
+    uint32_t h = x * 0x8da6b343u + yHash;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    h *= 0x297a2d39u;
+    h ^= h >> 15;
+    return h;
+}
+
+inline uint32_t hashLatticeRow(uint32_t y, uint32_t seed) {
+    return y * 0xd8163841u + seed * 0xcb1ab31fu;
+}
+
+extern const ProceduralKernels proceduralKernelsScalar;
+#ifdef TRIANGLE_X86_KERNELS
+// Defined in a translation unit built with -mavx2 -mfma; only use them after
+// checking detectSimdLevel(). Noise is 8 texels per register, so SSE4.1 gains
+// little over scalar and has no kernels of its own.
+extern const ProceduralKernels proceduralKernelsAvx2;
+#endif
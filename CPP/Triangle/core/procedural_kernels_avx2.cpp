@@ -0,0 +1,183 @@
+// Built with -mavx2 -mfma; only reached through getProceduralKernels()
+#include "procedural_kernels.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+
+inline __m256i hash8(__m256i x, __m256i yHash) {
+    __m256i h = _mm256_add_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x8da6b343u)), yHash);
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x2c1b3c6d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x297a2d39));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+}
+
+inline __m256 fade8(__m256 t) {
+    __m256 inner = _mm256_fmadd_ps(t, _mm256_fmadd_ps(t, _mm256_set1_ps(6.0f), _mm256_set1_ps(-15.0f)), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+}
+
+inline __m256 lerp8(__m256 a, __m256 b, __m256 t) {
+    return _mm256_fmadd_ps(_mm256_sub_ps(b, a), t, a);
+}
+
+inline __m256 value8(__m256i h) {
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+
+// Bit 2 of the hash swaps x and y, bits 0 and 1 flip the signs (by xoring
+// them into the float sign bit), and v is doubled
+inline __m256 gradient8(__m256i h, __m256 x, __m256 y) {
+    __m256 swap = _mm256_castsi256_ps(_mm256_slli_epi32(h, 29));
+    __m256 u = _mm256_blendv_ps(x, y, swap);
+    __m256 v = _mm256_blendv_ps(y, x, swap);
+    u = _mm256_xor_ps(u, _mm256_castsi256_ps(_mm256_slli_epi32(h, 31)));
+    v = _mm256_xor_ps(_mm256_add_ps(v, v), _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31)));
+    return _mm256_add_ps(u, v);
+}
+
+// Lattice cells of 8 coordinates, wrapped to the period as in latticeCell()
+struct Cells8 {
+    __m256i cell;
+    __m256i next;
+    __m256 fraction;
+};
+
+inline Cells8 cells8(__m256 coordinate, __m256i period) {
+    Cells8 result;
+    __m256 floored = _mm256_floor_ps(coordinate);
+    result.fraction = _mm256_sub_ps(coordinate, floored);
+    __m256i cell = _mm256_cvttps_epi32(floored);
+    // cell >= period  <=>  cell > period - 1
+    __m256i over = _mm256_cmpgt_epi32(cell, _mm256_sub_epi32(period, _mm256_set1_epi32(1)));
+    result.cell = _mm256_sub_epi32(cell, _mm256_and_si256(over, period));
+    __m256i next = _mm256_add_epi32(result.cell, _mm256_set1_epi32(1));
+    result.next = _mm256_andnot_si256(_mm256_cmpeq_epi32(next, period), next);
+    return result;
+}
+
+// Scalar row setup shared by both noise kernels
+struct RowSetup {
+    uint32_t row0, row1;
+    float fy, sy;
+};
+
+inline RowSetup setupRow(const NoiseRow& row) {
+    RowSetup setup;
+    float floored = std::floor(row.y);
+    int cell = (int)floored;
+    setup.fy = row.y - floored;
+    if (cell >= row.periodY) {
+        cell -= row.periodY;
+    }
+    int next = cell + 1 == row.periodY ? 0 : cell + 1;
+    setup.row0 = hashLatticeRow((uint32_t)cell, row.seed);
+    setup.row1 = hashLatticeRow((uint32_t)next, row.seed);
+    float t = setup.fy;
+    setup.sy = t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    return setup;
+}
+
+// Remaining texels go through the scalar kernel, starting where the vector loop stopped
+inline NoiseRow tailRow(const NoiseRow& row, int start) {
+    NoiseRow tail = row;
+    tail.x0 = row.x0 + (float)start * row.dx;
+    return tail;
+}
+
+inline __m256 rowCoordinates(const NoiseRow& row, int i) {
+    __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    return _mm256_fmadd_ps(index, _mm256_set1_ps(row.dx), _mm256_set1_ps(row.x0));
+}
+
+void valueNoiseRow(const NoiseRow& row, float* out, int count) {
+    RowSetup setup = setupRow(row);
+    const __m256i row0 = _mm256_set1_epi32((int)setup.row0);
+    const __m256i row1 = _mm256_set1_epi32((int)setup.row1);
+    const __m256i period = _mm256_set1_epi32(row.periodX);
+    const __m256 sy = _mm256_set1_ps(setup.sy);
+    const __m256 amplitude = _mm256_set1_ps(row.amplitude);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        Cells8 cx = cells8(rowCoordinates(row, i), period);
+        __m256 sx = fade8(cx.fraction);
+        __m256 top = lerp8(value8(hash8(cx.cell, row0)), value8(hash8(cx.next, row0)), sx);
+        __m256 bottom = lerp8(value8(hash8(cx.cell, row1)), value8(hash8(cx.next, row1)), sx);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(amplitude, lerp8(top, bottom, sy), _mm256_loadu_ps(out + i)));
+    }
+    if (i < count) {
+        proceduralKernelsScalar.valueNoiseRow(tailRow(row, i), out + i, count - i);
+    }
+}
+
+void perlinNoiseRow(const NoiseRow& row, float* out, int count) {
+    RowSetup setup = setupRow(row);
+    const __m256i row0 = _mm256_set1_epi32((int)setup.row0);
+    const __m256i row1 = _mm256_set1_epi32((int)setup.row1);
+    const __m256i period = _mm256_set1_epi32(row.periodX);
+    const __m256 fy0 = _mm256_set1_ps(setup.fy);
+    const __m256 fy1 = _mm256_set1_ps(setup.fy - 1.0f);
+    const __m256 sy = _mm256_set1_ps(setup.sy);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 amplitude = _mm256_set1_ps(row.amplitude * 0.507f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        Cells8 cx = cells8(rowCoordinates(row, i), period);
+        __m256 fx0 = cx.fraction;
+        __m256 fx1 = _mm256_sub_ps(fx0, one);
+        __m256 sx = fade8(fx0);
+        __m256 top = lerp8(gradient8(hash8(cx.cell, row0), fx0, fy0), gradient8(hash8(cx.next, row0), fx1, fy0), sx);
+        __m256 bottom = lerp8(gradient8(hash8(cx.cell, row1), fx0, fy1), gradient8(hash8(cx.next, row1), fx1, fy1), sx);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(amplitude, lerp8(top, bottom, sy), _mm256_loadu_ps(out + i)));
+    }
+    if (i < count) {
+        proceduralKernelsScalar.perlinNoiseRow(tailRow(row, i), out + i, count - i);
+    }
+}
+
+void radialRow(float x0, float dx, float y, float* out, int count) {
+    const __m256 yy = _mm256_set1_ps(y * y);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+        __m256 x = _mm256_fmadd_ps(index, _mm256_set1_ps(dx), _mm256_set1_ps(x0));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_fmadd_ps(x, x, yy)));
+    }
+    if (i < count) {
+        proceduralKernelsScalar.radialRow(x0 + (float)i * dx, dx, y, out + i, count - i);
+    }
+}
+
+// Eight texels per iteration: each t is spread over its four channels with a
+// lane permute, giving two texels per register
+void shadeRow(const float* t, const float* color0, const float* color1, unsigned char* out, int count) {
+    const __m256 base = _mm256_setr_ps(color0[0], color0[1], color0[2], color0[3], color0[0], color0[1], color0[2], color0[3]);
+    const __m256 delta = _mm256_sub_ps(
+        _mm256_setr_ps(color1[0], color1[1], color1[2], color1[3], color1[0], color1[1], color1[2], color1[3]), base);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 s = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(t + i), zero), one);
+        __m256i channels[4];
+        for (int k = 0; k < 4; k++) {
+            __m256i spread = _mm256_setr_epi32(2 * k, 2 * k, 2 * k, 2 * k, 2 * k + 1, 2 * k + 1, 2 * k + 1, 2 * k + 1);
+            __m256 pair = _mm256_permutevar8x32_ps(s, spread);
+            channels[k] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_fmadd_ps(delta, pair, base), half));
+        }
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(channels[0], channels[1]), _mm256_packs_epi32(channels[2], channels[3]));
+        _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    if (i < count) {
+        proceduralKernelsScalar.shadeRow(t + i, color0, color1, out + i * 4, count - i);
+    }
+}
+
+}
+
+const ProceduralKernels proceduralKernelsAvx2 = { valueNoiseRow, perlinNoiseRow, radialRow, shadeRow };
@@ -0,0 +1,186 @@
+#include "procedural_texture.h"
+#include "procedural_kernels.h"
+#include "row_bands.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Textures smaller than this are generated on the calling thread only
+static const size_t minParallelTexels = 65536;
+
+// Lattice cells in the finest octave are limited so coordinates stay exact in floats
+static const int maxLatticeCells = 1 << 20;
+
+const char* proceduralPatternName(ProceduralPattern pattern) {
+    switch (pattern) {
+    case ProceduralPattern::Checker:
+        return "checker";
+    case ProceduralPattern::LinearGradient:
+        return "linear-gradient";
+    case ProceduralPattern::RadialGradient:
+        return "radial-gradient";
+    case ProceduralPattern::ValueNoise:
+        return "value-noise";
+    case ProceduralPattern::PerlinNoise:
+        return "perlin-noise";
+    }
+    return "unknown";
+}
+
+static bool validate(const ProceduralTexture& texture, int width, int height) {
+    if (width < 1 || height < 1 || (size_t)width * height > ((size_t)1 << 32)) {
+        std::cerr << "Invalid procedural texture size " << width << "x" << height << std::endl;
+        return false;
+    }
+    if (texture.pattern == ProceduralPattern::Checker && texture.cellSize < 1) {
+        std::cerr << "Procedural checker cell size must be positive" << std::endl;
+        return false;
+    }
+    if (texture.pattern == ProceduralPattern::ValueNoise || texture.pattern == ProceduralPattern::PerlinNoise) {
+        if (texture.frequency < 1 || texture.octaves < 1 || texture.octaves > 16 ||
+            ((long long)texture.frequency << (texture.octaves - 1)) > maxLatticeCells) {
+            std::cerr << "Procedural noise needs a positive frequency and 1-16 octaves, with at most "
+                      << maxLatticeCells << " cells in the last octave" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Blend factors of one row
+class RowGenerator {
+private:
+    const ProceduralTexture& texture;
+    const ProceduralKernels& kernels;
+    int width, height;
+
+    // Noise: lattice periods of the first octave and the amplitude of each octave
+    int periodX, periodY;
+    std::vector<float> amplitudes;
+    float noiseBias;
+
+    // LinearGradient: t = x * gradientX + y * gradientY + gradientBase
+    float gradientX, gradientY, gradientBase;
+
+public:
+    RowGenerator(const ProceduralTexture& texture, const ProceduralKernels& kernels, int width, int height)
+        : texture(texture), kernels(kernels), width(width), height(height) {
+        // Cells stay square as far as whole cells across the height allow
+        periodX = texture.frequency;
+        periodY = std::max(1, (int)std::lround((double)texture.frequency * height / width));
+        // Octave amplitudes normalized to sum to 1; Perlin noise is centred on 0.5
+        bool perlin = texture.pattern == ProceduralPattern::PerlinNoise;
+        float amplitude = 1.0f, total = 0.0f;
+        for (int octave = 0; octave < texture.octaves; octave++) {
+            amplitudes.push_back(amplitude);
+            total += amplitude;
+            amplitude *= texture.persistence;
+        }
+        for (float& value : amplitudes) {
+            value = value / total * (perlin ? 0.5f : 1.0f);
+        }
+        noiseBias = perlin ? 0.5f : 0.0f;
+
+        // Texel centres, with the corners the gradient starts and ends on mapped to 0 and 1
+        float radians = texture.angle * 3.14159265358979f / 180.0f;
+        float dx = std::cos(radians), dy = -std::sin(radians);
+        float low = 0.0f, high = 0.0f;
+        for (int corner = 0; corner < 4; corner++) {
+            float value = ((corner & 1) ? width - 1 : 0) * dx + ((corner & 2) ? height - 1 : 0) * dy;
+            low = corner == 0 ? value : std::min(low, value);
+            high = corner == 0 ? value : std::max(high, value);
+        }
+        float scale = high > low ? 1.0f / (high - low) : 0.0f;
+        gradientX = dx * scale;
+        gradientY = dy * scale;
+        gradientBase = -low * scale;
+    }
+
+    void generate(int y, float* t) const {
+        switch (texture.pattern) {
+        case ProceduralPattern::Checker: {
+            // Runs of whole cells
+            int cell = texture.cellSize;
+            float value = (float)((y / cell) & 1);
+            for (int x = 0; x < width; x += cell) {
+                std::fill(t + x, t + std::min(x + cell, width), value);
+                value = 1.0f - value;
+            }
+            break;
+        }
+        case ProceduralPattern::LinearGradient: {
+            float base = gradientBase + y * gradientY;
+            for (int x = 0; x < width; x++) {
+                t[x] = base + x * gradientX;
+            }
+            break;
+        }
+        case ProceduralPattern::RadialGradient: {
+            // Distance in half-sizes from the centre: 1 at the middle of each edge
+            float dx = 2.0f / width;
+            float dy = 2.0f / height;
+            kernels.radialRow(0.5f * dx - 1.0f, dx, (y + 0.5f) * dy - 1.0f, t, width);
+            break;
+        }
+        case ProceduralPattern::ValueNoise:
+        case ProceduralPattern::PerlinNoise: {
+            auto noiseRow = texture.pattern == ProceduralPattern::ValueNoise ? kernels.valueNoiseRow : kernels.perlinNoiseRow;
+            std::fill(t, t + width, noiseBias);
+            for (int octave = 0; octave < texture.octaves; octave++) {
+                NoiseRow row;
+                row.periodX = periodX << octave;
+                row.periodY = periodY << octave;
+                row.dx = (float)row.periodX / width;
+                row.x0 = 0.5f * row.dx;
+                row.y = (y + 0.5f) * row.periodY / height;
+                row.seed = texture.seed + (uint32_t)octave * 0x9e3779b9u;
+                row.amplitude = amplitudes[octave];
+                noiseRow(row, t, width);
+            }
+            break;
+        }
+        }
+    }
+
+    // Whether row y repeats the row above it
+    bool sameAsPrevious(int y) const {
+        return texture.pattern == ProceduralPattern::Checker && y % texture.cellSize != 0;
+    }
+};
+
+bool generateProceduralTexture(const ProceduralTexture& texture, int width, int height, unsigned char* rgba,
+                               const ProceduralOptions& options) {
+    if (!rgba || !validate(texture, width, height)) {
+        return false;
+    }
+    TraceZone zone("procedural texture", "texture");
+
+    const ProceduralKernels& kernels = getProceduralKernels(std::min(detectSimdLevel(), options.maxSimd));
+    RowGenerator generator(texture, kernels, width, height);
+    float color0[4], color1[4];
+    for (int c = 0; c < 4; c++) {
+        color0[c] = texture.color0[c];
+        color1[c] = texture.color1[c];
+    }
+    size_t rowBytes = (size_t)width * 4;
+
+    auto generateRows = [&](int first, int last) {
+        std::vector<float> t(width);
+        for (int y = first; y < last; y++) {
+            unsigned char* out = rgba + rowBytes * y;
+            if (y > first && generator.sameAsPrevious(y)) {
+                std::memcpy(out, out - rowBytes, rowBytes);
+                continue;
+            }
+            generator.generate(y, t.data());
+            kernels.shadeRow(t.data(), color0, color1, out, width);
+        }
+    };
+
+    forEachRowBand(height, (size_t)width * height >= minParallelTexels ? options.threads : 1, generateRows);
+    return true;
+}
@@ -0,0 +1,168 @@
+#include "program_cache.h"
+#include "gl_extensions.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// File layout: header, then the driver's binary blob
+struct CacheEntryHeader {
+    char magic[4];
+    uint32_t binaryFormat;
+    uint32_t length;
+    uint32_t reserved;
+    uint64_t key;
+};
+
+static const char cacheMagic[4] = { 'T', 'P', 'B', '1' };
+
+// FNV-1a, 64 bit
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hashEntry(const std::string& driverKey, const std::string& vertexCode, const std::string& fragmentCode) {
+    uint64_t hash = 14695981039346656037ull;
+    // The terminating zeros keep ("ab", "c") and ("a", "bc") apart
+    hash = hashBytes(hash, driverKey.c_str(), driverKey.size() + 1);
+    hash = hashBytes(hash, vertexCode.c_str(), vertexCode.size() + 1);
+    hash = hashBytes(hash, fragmentCode.c_str(), fragmentCode.size() + 1);
+    return hash;
+}
+
+static bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+ProgramCache::ProgramCache() : hits(0), misses(0), createMs(0.0) {}
+
+bool ProgramCache::open(const std::string& path) {
+    directory.clear();
+    if (path.empty()) {
+        return true;
+    }
+    if (!getGLExtensions().programBinary) {
+        std::cout << "Shader cache disabled: the driver does not support program binaries" << std::endl;
+        return false;
+    }
+    if (!makeDirectory(path)) {
+        std::cerr << "Shader cache disabled: cannot create " << path << std::endl;
+        return false;
+    }
+    directory = path;
+
+    auto glString = [](GLenum name) {
+        const char* value = (const char*)glGetString(name);
+        return std::string(value ? value : "");
+    };
+    driverKey = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    return true;
+}
+
+std::string ProgramCache::entryPath(const std::string& vertexCode, const std::string& fragmentCode) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hashEntry(driverKey, vertexCode, fragmentCode));
+    return directory + "/" + name;
+}
+
+GLuint ProgramCache::load(const std::string& vertexCode, const std::string& fragmentCode) {
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    std::ifstream file(entryPath(vertexCode, fragmentCode), std::ios::binary);
+    CacheEntryHeader header;
+    if (!file || !file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, cacheMagic, 4) != 0 ||
+        header.key != hashEntry(driverKey, vertexCode, fragmentCode)) {
+        return 0;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) {
+        return 0;
+    }
+
+    const GLExtensions& gl = getGLExtensions();
+    GLuint program = glCreateProgram();
+    gl.programBinaryLoad(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    hits++;
+    return program;
+}
+
+void ProgramCache::prepare(GLuint program) {
+    if (isEnabled()) {
+        getGLExtensions().programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ProgramCache::store(const std::string& vertexCode, const std::string& fragmentCode, GLuint program) {
+    if (!isEnabled()) {
+        return;
+    }
+    misses++;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(length);
+    CacheEntryHeader header;
+    std::memcpy(header.magic, cacheMagic, 4);
+    header.reserved = 0;
+    header.key = hashEntry(driverKey, vertexCode, fragmentCode);
+    GLsizei written = 0;
+    getGLExtensions().getProgramBinary(program, length, &written, &header.binaryFormat, binary.data());
+    header.length = (uint32_t)written;
+    if (written <= 0) {
+        return;
+    }
+
+    // Write to a temporary name and rename, so a concurrent reader never sees half a file
+    std::string path = entryPath(vertexCode, fragmentCode);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), written)) {
+            std::cerr << "Failed to write shader cache entry " << temporary << std::endl;
+            return;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+void ProgramCache::printSummary() const {
+    if (!isEnabled()) {
+        return;
+    }
+    std::cout << "Shader cache: " << hits << " loaded, " << misses << " compiled ("
+              << createMs << " ms creating programs)" << std::endl;
+}
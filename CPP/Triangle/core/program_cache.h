@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <glad/glad.h>
+
+// On-disk cache of linked program binaries (glGetProgramBinary /
+// glProgramBinary), so warm starts skip GLSL compilation and linking.
+//
+// Entries are keyed by a hash of both shader sources (prelude included) and
+// the GL vendor, renderer and version strings, so a driver update or a
+// different GPU never sees a foreign binary. A binary the driver rejects
+// anyway is treated as a miss: the program is compiled from source and the
+// entry rewritten.
+class ProgramCache {
+private:
+    std::string directory;
+    std::string driverKey;
+    int hits;
+    int misses;
+    double createMs;
+
+    std::string entryPath(const std::string& vertexCode, const std::string& fragmentCode);
+
+public:
+    ProgramCache();
+
+    // Empty directory = disabled. Creates the directory (one level) if needed;
+    // false (and disabled) if that fails or the driver cannot save binaries.
+    bool open(const std::string& directory);
+    bool isEnabled() const { return !directory.empty(); }
+
+    // A linked program from the cache, or 0 on a miss
+    GLuint load(const std::string& vertexCode, const std::string& fragmentCode);
+    // Call before linking a program that will be stored
+    void prepare(GLuint program);
+    // Saves the binary of a program that was just compiled and linked
+    void store(const std::string& vertexCode, const std::string& fragmentCode, GLuint program);
+
+    // Bookkeeping for printSummary(): time spent creating each program
+    void recordCreateTime(double ms) { createMs += ms; }
+    void printSummary() const;
+};
@@ -0,0 +1,28 @@
+#include "row_bands.h"
+#include "softraster/worker_pool.h"
+
+#include <algorithm>
+#include <mutex>
+
+void forEachRowBand(int rows, int threads, const std::function<void(int first, int last)>& band) {
+    static WorkerPool pool;
+    static std::mutex poolMutex;
+
+    int workers = std::min(threads > 0 ? threads : pool.getWorkerCount(), pool.getWorkerCount());
+    workers = std::min(workers, rows);
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (workers <= 1 || !lock.try_lock()) {
+        band(0, rows);
+        return;
+    }
+    // Workers past the requested count get an empty band
+    pool.run([&](int index) {
+        if (index < workers) {
+            int first = (int)((long long)rows * index / workers);
+            int last = (int)((long long)rows * (index + 1) / workers);
+            if (first < last) {
+                band(first, last);
+            }
+        }
+    });
+}
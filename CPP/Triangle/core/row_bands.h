@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+
+// Splits [0, rows) into one band per worker and runs band(first, last) on a
+// process-wide WorkerPool, returning once every band is done. threads caps
+// the workers (0 = one per hardware thread, 1 = the calling thread only).
+//
+// The pool is created on first use and lives as long as the process, so no
+// call spawns threads. It runs one job at a time: a caller that finds it busy
+// (say a second texture decode thread) does all its rows itself, so
+// concurrent callers never run more threads than the pool plus themselves.
+void forEachRowBand(int rows, int threads, const std::function<void(int first, int last)>& band);
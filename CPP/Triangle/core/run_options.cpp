@@ -0,0 +1,125 @@
+#include "run_options.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--headless] [--frames N] [--benchmark] [--warmup M] [--benchmark-out FILE]"
+              << " [--instances N] [--shader-cache DIR | --no-shader-cache] [--clock realtime|replay]"
+              << " [--gpu-profile] [--profile-log FILE] [--trace FILE]"
+              << " [--capture PATTERN] [--capture-every N] [--texture FILE] [--texture-budget MIB]" << std::endl;
+}
+
+// Parses a non-negative integer option value
+static bool parseCount(const char* text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0 || parsed > 100000000) {
+        return false;
+    }
+    value = (int)parsed;
+    return true;
+}
+
+bool parseRunOptions(int argc, char** argv, RunOptions& options) {
+    const char* headlessEnv = std::getenv("TRIANGLE_HEADLESS");
+    if (headlessEnv && std::strcmp(headlessEnv, "0") != 0) {
+        options.headless = true;
+    }
+
+    bool warmupGiven = false;
+    bool clockGiven = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--benchmark") {
+            options.benchmark = true;
+        } else if (arg == "--frames" && hasValue) {
+            if (!parseCount(argv[++i], options.frames)) {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else if (arg == "--warmup" && hasValue) {
+            if (!parseCount(argv[++i], options.warmup)) {
+                printUsage(argv[0]);
+                return false;
+            }
+            warmupGiven = true;
+        } else if (arg == "--instances" && hasValue) {
+            if (!parseCount(argv[++i], options.instances) || options.instances > kMaxInstances) {
+                std::cerr << "--instances must be between 0 and " << kMaxInstances << std::endl;
+                return false;
+            }
+        } else if (arg == "--benchmark-out" && hasValue) {
+            options.benchmarkOutput = argv[++i];
+        } else if (arg == "--shader-cache" && hasValue) {
+            options.shaderCache = argv[++i];
+        } else if (arg == "--no-shader-cache") {
+            options.shaderCache.clear();
+        } else if (arg == "--clock" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "realtime") {
+                options.clock = ClockMode::RealTime;
+            } else if (mode == "replay") {
+                options.clock = ClockMode::Replay;
+            } else {
+                std::cerr << "--clock must be realtime or replay" << std::endl;
+                return false;
+            }
+            clockGiven = true;
+        } else if (arg == "--gpu-profile") {
+            options.gpuProfile = true;
+        } else if (arg == "--profile-log" && hasValue) {
+            options.profileLog = argv[++i];
+            options.gpuProfile = true;
+        } else if (arg == "--capture" && hasValue) {
+            options.capturePattern = argv[++i];
+        } else if (arg == "--capture-every" && hasValue) {
+            if (!parseCount(argv[++i], options.captureEvery) || options.captureEvery == 0) {
+                std::cerr << "--capture-every must be positive" << std::endl;
+                return false;
+            }
+        } else if (arg == "--texture" && hasValue) {
+            options.texture = argv[++i];
+        } else if (arg == "--texture-budget" && hasValue) {
+            if (!parseCount(argv[++i], options.textureBudgetMiB) || options.textureBudgetMiB > (1 << 20)) {
+                std::cerr << "--texture-budget must be between 0 and " << (1 << 20) << " MiB" << std::endl;
+                return false;
+            }
+        } else if (arg == "--trace" && hasValue) {
+            options.traceFile = argv[++i];
+            options.gpuProfile = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.benchmark) {
+        if (options.frames == 0) {
+            options.frames = kDefaultBenchmarkFrames;
+        }
+        if (!warmupGiven) {
+            options.warmup = kDefaultBenchmarkWarmup;
+        }
+    } else if (warmupGiven) {
+        std::cerr << "--warmup only applies to --benchmark runs" << std::endl;
+        options.warmup = 0;
+    }
+
+    // A headless run has no window to close, so it always needs a frame budget
+    if (options.headless && options.frames == 0) {
+        options.frames = kDefaultHeadlessFrames;
+    }
+
+    // Measured and offscreen runs should render the same frames on every machine
+    if (!clockGiven && (options.benchmark || options.headless)) {
+        options.clock = ClockMode::Replay;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include "sim_clock.h"
+
+// Command line options shared by all demos:
+//   --headless            render offscreen through EGL, no window or display server needed
+//                         (also enabled by setting TRIANGLE_HEADLESS=1)
+//   --frames N            stop after N frames (0 = until the window is closed)
+//   --benchmark           fixed-length run with vsync off; writes frame time statistics as JSON
+//   --warmup M            frames rendered before measuring starts (benchmark mode)
+//   --benchmark-out FILE  where to write the JSON ("-" for stdout, default <demo>_benchmark.json)
+//   --instances N         stress mode: draw N instanced triangles per frame
+//                         (phong_triangle and rose_textured_triangle)
+//   --shader-cache DIR    directory for cached program binaries (default shader_cache)
+//   --no-shader-cache     always compile shaders from source
+//   --gpu-profile         time clear, draw and swap on the GPU with timer queries; shown in the
+//                         window title and added to the benchmark JSON
+//   --profile-log FILE    also write CPU and GPU times of every frame as JSON lines (implies --gpu-profile)
+//   --trace FILE          write CPU and GPU events as Chrome trace JSON on exit (implies --gpu-profile)
+//   --capture PATTERN     read frames back asynchronously and write them as images, e.g.
+//                         frames/%05d.png (frame number); .png or .ppm
+//   --capture-every N     capture every Nth frame only (default 1)
+//   --texture FILE        rose_textured_triangle: load this image instead of the first of
+//                         rose_bc7.ktx2, rose.ktx2 and rose.png that exists
+//   --texture-budget MIB  texture memory the shared TextureManager keeps before evicting unused
+//                         textures (default 256)
+//   --clock MODE          animation clock: "realtime" (default in a window) or "replay"
+//                         (one fixed step per frame, default for --headless and --benchmark)
+struct RunOptions {
+    bool headless = false;
+    int frames = 0;
+    bool benchmark = false;
+    int warmup = 0;
+    std::string benchmarkOutput;
+    int instances = 0;
+    std::string shaderCache = "shader_cache";  // empty = disabled
+    ClockMode clock = ClockMode::RealTime;
+    bool gpuProfile = false;
+    std::string profileLog;
+    std::string traceFile;
+    std::string capturePattern;
+    int captureEvery = 1;
+    std::string texture;
+    int textureBudgetMiB = 256;
+};
+
+// Upper bound for --instances (64 bytes of instance data each)
+constexpr int kMaxInstances = 1 << 24;
+
+// Frames rendered by a headless run when --frames is not given
+constexpr int kDefaultHeadlessFrames = 600;
+
+// Defaults for --benchmark
+constexpr int kDefaultBenchmarkFrames = 1000;
+constexpr int kDefaultBenchmarkWarmup = 60;
+
+// Returns false (after printing usage) if the arguments are invalid
+bool parseRunOptions(int argc, char** argv, RunOptions& options);
@@ -0,0 +1,249 @@
+#include "shader_program.h"
+
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include "trace.h"
+
+static GLuint compileShader(GLenum type, const char* source, const char* typeName) {
+    TraceZone zone(type == GL_VERTEX_SHADER ? "compile vertex shader" : "compile fragment shader", "shader");
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::string infoLog(logLength > 1 ? logLength : 1, '\0');
+        glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), nullptr, &infoLog[0]);
+        std::cerr << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n" << infoLog.c_str() << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// GLSL requires #version to come first, so the prelude goes after that line
+static std::string insertPrelude(const char* source, const std::string& prelude) {
+    std::string result = source;
+    if (prelude.empty()) {
+        return result;
+    }
+
+    size_t insertAt = 0;
+    size_t version = result.find("#version");
+    if (version != std::string::npos) {
+        size_t lineEnd = result.find('\n', version);
+        if (lineEnd == std::string::npos) {
+            result += '\n';
+            lineEnd = result.size() - 1;
+        }
+        insertAt = lineEnd + 1;
+    }
+    result.insert(insertAt, prelude);
+    return result;
+}
+
+ShaderProgram::ShaderProgram() : program(0) {}
+
+ShaderProgram::~ShaderProgram() {
+    destroy();
+}
+
+bool ShaderProgram::create(const char* vertexSource, const char* fragmentSource, const std::string& prelude,
+                           ProgramCache* cache) {
+    destroy();
+    TraceZone zone("create program", "shader");
+    auto start = std::chrono::steady_clock::now();
+
+    std::string vertexCode = insertPrelude(vertexSource, prelude);
+    std::string fragmentCode = insertPrelude(fragmentSource, prelude);
+
+    if (cache) {
+        TraceZone loadZone("load program binary", "shader");
+        program = cache->load(vertexCode, fragmentCode);
+        if (program) {
+            reflectUniforms();
+            cache->recordCreateTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            return true;
+        }
+    }
+
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexCode.c_str(), "VERTEX");
+    if (!vertexShader) {
+        return false;
+    }
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentCode.c_str(), "FRAGMENT");
+    if (!fragmentShader) {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    if (cache) {
+        cache->prepare(program);
+    }
+    {
+        TraceZone linkZone("link program", "shader");
+        glLinkProgram(program);
+    }
+
+    // The program keeps what it needs; the shader objects can go right away
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLint logLength = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::string infoLog(logLength > 1 ? logLength : 1, '\0');
+        glGetProgramInfoLog(program, (GLsizei)infoLog.size(), nullptr, &infoLog[0]);
+        std::cerr << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog.c_str() << std::endl;
+        destroy();
+        return false;
+    }
+
+    if (cache) {
+        TraceZone storeZone("store program binary", "shader");
+        cache->store(vertexCode, fragmentCode, program);
+        cache->recordCreateTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    reflectUniforms();
+    return true;
+}
+
+void ShaderProgram::destroy() {
+    if (program) {
+        glDeleteProgram(program);
+        program = 0;
+    }
+    uniforms.clear();
+}
+
+void ShaderProgram::reflectUniforms() {
+    uniforms.clear();
+
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        Uniform uniform;
+        GLsizei nameLength = 0;
+        glGetActiveUniform(program, (GLuint)i, (GLsizei)nameBuffer.size(), &nameLength, &uniform.size, &uniform.type, nameBuffer.data());
+        uniform.name.assign(nameBuffer.data(), nameLength);
+
+        // Arrays are reported as "name[0]"; look them up by their plain name
+        if (uniform.name.size() > 3 && uniform.name.compare(uniform.name.size() - 3, 3, "[0]") == 0) {
+            uniform.name.resize(uniform.name.size() - 3);
+        }
+
+        // Members of uniform blocks have no location and are not set through here
+        uniform.location = glGetUniformLocation(program, nameBuffer.data());
+        if (uniform.location < 0) {
+            continue;
+        }
+
+        // Linking initializes every uniform to zero, which is what the cache starts with
+        std::memset(uniform.value, 0, sizeof(uniform.value));
+        uniform.typeErrorReported = false;
+        uniforms.push_back(uniform);
+    }
+}
+
+bool ShaderProgram::bindUniformBlock(const char* name, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(program, name);
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(program, index, binding);
+    return true;
+}
+
+UniformHandle ShaderProgram::getUniform(const char* name) const {
+    for (size_t i = 0; i < uniforms.size(); i++) {
+        if (uniforms[i].name == name) {
+            return (UniformHandle)i;
+        }
+    }
+    return -1;
+}
+
+bool ShaderProgram::checkType(Uniform& uniform, GLenum type) {
+    // Samplers are set through their texture unit index
+    bool isSampler = uniform.type == GL_SAMPLER_2D || uniform.type == GL_SAMPLER_3D || uniform.type == GL_SAMPLER_CUBE;
+    if (uniform.type == type || (type == GL_INT && (isSampler || uniform.type == GL_BOOL))) {
+        return true;
+    }
+    if (!uniform.typeErrorReported) {
+        std::cerr << "Uniform '" << uniform.name << "' set with the wrong type" << std::endl;
+        uniform.typeErrorReported = true;
+    }
+    return false;
+}
+
+bool ShaderProgram::updateCache(Uniform& uniform, const void* data, size_t size) {
+    if (std::memcmp(uniform.value, data, size) == 0) {
+        return false;
+    }
+    std::memcpy(uniform.value, data, size);
+    return true;
+}
+
+void ShaderProgram::set(UniformHandle handle, int value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_INT) && updateCache(uniform, &value, sizeof(value))) {
+        glUniform1i(uniform.location, value);
+    }
+}
+
+void ShaderProgram::set(UniformHandle handle, float value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_FLOAT) && updateCache(uniform, &value, sizeof(value))) {
+        glUniform1f(uniform.location, value);
+    }
+}
+
+void ShaderProgram::set(UniformHandle handle, const glm::vec3& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_FLOAT_VEC3) && updateCache(uniform, &value[0], sizeof(float) * 3)) {
+        glUniform3fv(uniform.location, 1, &value[0]);
+    }
+}
+
+void ShaderProgram::set(UniformHandle handle, const glm::vec4& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_FLOAT_VEC4) && updateCache(uniform, &value[0], sizeof(float) * 4)) {
+        glUniform4fv(uniform.location, 1, &value[0]);
+    }
+}
+
+void ShaderProgram::set(UniformHandle handle, const glm::mat3& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_FLOAT_MAT3) && updateCache(uniform, &value[0][0], sizeof(float) * 9)) {
+        glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &value[0][0]);
+    }
+}
+
+void ShaderProgram::set(UniformHandle handle, const glm::mat4& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (checkType(uniform, GL_FLOAT_MAT4) && updateCache(uniform, &value[0][0], sizeof(float) * 16)) {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &value[0][0]);
+    }
+}
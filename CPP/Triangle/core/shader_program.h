@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "program_cache.h"
+
+// Index into a ShaderProgram's uniform table; -1 means "not an active uniform"
+// and, like a -1 location in OpenGL, is silently ignored by the setters.
+using UniformHandle = int;
+
+// Compiles and links a GLSL program and reflects its active uniforms once at
+// link time (glGetActiveUniform), so per-frame code never does string lookups.
+//
+// Every uniform remembers the last value uploaded to it. Setting a value that
+// is already current is skipped, so constant uniforms such as the projection
+// matrix cost one comparison per frame instead of a driver call. Setters upload
+// to the program currently in use: call use() first.
+class ShaderProgram {
+private:
+    struct Uniform {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size;
+        // Last uploaded value (big enough for a mat4)
+        float value[16];
+        bool typeErrorReported;
+    };
+
+    GLuint program;
+    std::vector<Uniform> uniforms;
+
+    void reflectUniforms();
+    bool checkType(Uniform& uniform, GLenum type);
+    // Returns true if the cached value changed (and updates the cache)
+    bool updateCache(Uniform& uniform, const void* data, size_t size);
+
+public:
+    ShaderProgram();
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // The prelude (shared declarations, #defines) is inserted right after the
+    // #version line of both shaders. With a cache, a stored binary replaces
+    // compiling and linking when one matches.
+    bool create(const char* vertexSource, const char* fragmentSource, const std::string& prelude = "",
+                ProgramCache* cache = nullptr);
+    void destroy();
+
+    // Connects a uniform block to a buffer binding point; false if the block is not active
+    bool bindUniformBlock(const char* name, GLuint binding);
+
+    void use() const { glUseProgram(program); }
+    GLuint getId() const { return program; }
+
+    UniformHandle getUniform(const char* name) const;
+
+    void set(UniformHandle handle, int value);
+    void set(UniformHandle handle, float value);
+    void set(UniformHandle handle, const glm::vec3& value);
+    void set(UniformHandle handle, const glm::vec4& value);
+    void set(UniformHandle handle, const glm::mat3& value);
+    void set(UniformHandle handle, const glm::mat4& value);
+};
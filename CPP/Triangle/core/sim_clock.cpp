@@ -0,0 +1,42 @@
+#include "sim_clock.h"
+
+#include <algorithm>
+
+SimulationClock::SimulationClock(double step, int maxStepsPerFrame)
+    : mode(ClockMode::RealTime), step(step), maxStepsPerFrame(maxStepsPerFrame),
+      accumulator(0.0), stepCount(0), started(false) {}
+
+void SimulationClock::reset(ClockMode newMode) {
+    mode = newMode;
+    accumulator = 0.0;
+    stepCount = 0;
+    started = false;
+}
+
+int SimulationClock::beginFrame() {
+    if (mode == ClockMode::Replay) {
+        stepCount++;
+        return 1;
+    }
+
+    // The first frame shows the initial state
+    Clock::time_point now = Clock::now();
+    if (!started) {
+        started = true;
+        lastFrame = now;
+        return 0;
+    }
+    accumulator += std::chrono::duration<double>(now - lastFrame).count();
+    lastFrame = now;
+
+    // Drop whatever does not fit in maxStepsPerFrame (e.g. after a breakpoint)
+    accumulator = std::min(accumulator, step * maxStepsPerFrame);
+    int steps = (int)(accumulator / step);
+    accumulator = std::max(accumulator - steps * step, 0.0);
+    stepCount += steps;
+    return steps;
+}
+
+const char* clockModeName(ClockMode mode) {
+    return mode == ClockMode::Replay ? "replay" : "realtime";
+}
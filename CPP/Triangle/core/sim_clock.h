@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+enum class ClockMode {
+    RealTime,   // steps follow the wall clock; rendering interpolates between steps
+    Replay      // exactly one step per frame: frame N shows the same state on every run
+};
+
+// Fixed-timestep simulation clock. Simulation code always advances by the
+// same step, so animation speed does not depend on the frame rate:
+//
+//   for (int i = clock.beginFrame(); i > 0; i--) {
+//       update(clock.getStep());
+//   }
+//   render(clock.getAlpha());   // blend previous and current state
+//
+// In real time mode the wall clock time since the last frame is split into
+// whole steps and a remainder (getAlpha()). Long stalls are capped at
+// maxStepsPerFrame steps, so a slow frame cannot snowball into ever more
+// simulation work. Replay mode ignores the wall clock entirely, which keeps
+// benchmarks and offscreen captures comparable across machines and runs.
+class SimulationClock {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ClockMode mode;
+    double step;
+    int maxStepsPerFrame;
+    double accumulator;
+    uint64_t stepCount;
+    bool started;
+    Clock::time_point lastFrame;
+
+public:
+    explicit SimulationClock(double step = 1.0 / 60.0, int maxStepsPerFrame = 8);
+
+    // Restarts at time zero
+    void reset(ClockMode mode);
+
+    // Number of fixed steps to simulate before rendering this frame
+    int beginFrame();
+
+    ClockMode getMode() const { return mode; }
+    double getStep() const { return step; }
+    // Fraction of a step between the last simulated state and now, in [0, 1)
+    double getAlpha() const { return accumulator / step; }
+    // Simulated time in seconds
+    double getTime() const { return (double)stepCount * step; }
+};
+
+const char* clockModeName(ClockMode mode);
@@ -0,0 +1,4 @@
+// The one translation unit that compiles stb_image; everything else includes
+// "stb_image.h" for the declarations only
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
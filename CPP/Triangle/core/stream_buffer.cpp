@@ -0,0 +1,191 @@
+#include "stream_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "gl_extensions.h"
+#include "trace.h"
+
+// Give up waiting on a region after this long (a lost context or a hung GPU)
+static const GLuint64 maxWaitNanoseconds = 5000000000ull;
+
+const char* streamMappingName(StreamMapping mapping) {
+    switch (mapping) {
+    case StreamMapping::Auto:
+        return "auto";
+    case StreamMapping::Persistent:
+        return "persistent";
+    case StreamMapping::Unsynchronized:
+        return "unsynchronized";
+    }
+    return "unknown";
+}
+
+StreamBuffer::StreamBuffer()
+    : target(GL_ARRAY_BUFFER), mapping(StreamMapping::Unsynchronized), regionSize(0), minAlignment(1), region(0),
+      offset(0), persistentData(nullptr), mapped(false), waitCount(0) {}
+
+StreamBuffer::~StreamBuffer() {
+    destroy();
+}
+
+bool StreamBuffer::create(GLenum target, size_t regionSize, int regionCount, StreamMapping mapping) {
+    destroy();
+    if (regionSize == 0 || regionCount < 1) {
+        std::cerr << "Stream buffer needs a non-empty region size and at least one region" << std::endl;
+        return false;
+    }
+
+    const GLExtensions& extensions = getGLExtensions();
+    if (mapping == StreamMapping::Auto) {
+        mapping = extensions.bufferStorage ? StreamMapping::Persistent : StreamMapping::Unsynchronized;
+    } else if (mapping == StreamMapping::Persistent && !extensions.bufferStorage) {
+        std::cerr << "Persistent stream buffers need GL 4.4 or ARB_buffer_storage" << std::endl;
+        return false;
+    }
+
+    this->target = target;
+    this->mapping = mapping;
+    minAlignment = 1;
+    if (target == GL_UNIFORM_BUFFER) {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        minAlignment = (size_t)std::max(alignment, 1);
+    }
+    // Regions start on an allocation boundary too
+    this->regionSize = (regionSize + minAlignment - 1) / minAlignment * minAlignment;
+    GLsizeiptr totalSize = (GLsizeiptr)(this->regionSize * regionCount);
+
+    if (!buffer.create()) {
+        std::cerr << "Failed to create stream buffer" << std::endl;
+        return false;
+    }
+    glBindBuffer(target, buffer.get());
+    if (mapping == StreamMapping::Persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        extensions.allocateBufferStorage(target, totalSize, nullptr, flags);
+        persistentData = (unsigned char*)glMapBufferRange(target, 0, totalSize, flags);
+        if (!persistentData) {
+            std::cerr << "Failed to map stream buffer persistently" << std::endl;
+            glBindBuffer(target, 0);
+            destroy();
+            return false;
+        }
+    } else {
+        glBufferData(target, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(target, 0);
+
+    fences.assign(regionCount, nullptr);
+    region = 0;
+    offset = 0;
+    waitCount = 0;
+    return true;
+}
+
+void StreamBuffer::destroy() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    fences.clear();
+    if (buffer && (persistentData || mapped)) {
+        glBindBuffer(target, buffer.get());
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    persistentData = nullptr;
+    mapped = false;
+    buffer.destroy();
+    regionSize = 0;
+    offset = 0;
+}
+
+void StreamBuffer::beginFrame() {
+    if (fences.empty()) {
+        return;
+    }
+    commit();
+    region = (region + 1) % (int)fences.size();
+    offset = 0;
+
+    GLsync& fence = fences[region];
+    if (!fence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        // The GPU is regionCount frames behind: wait for it rather than overwrite what it reads
+        TraceZone zone("stream buffer wait");
+        waitCount++;
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, maxWaitNanoseconds);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            std::cerr << "Stream buffer region still busy after waiting; overwriting it" << std::endl;
+        }
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+StreamAllocation StreamBuffer::allocate(size_t size, size_t alignment) {
+    StreamAllocation allocation = { nullptr, -1 };
+    if (fences.empty()) {
+        return allocation;
+    }
+    commit();
+
+    alignment = std::max(alignment, minAlignment);
+    size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (size == 0 || start > regionSize || size > regionSize - start) {
+        return allocation;
+    }
+    offset = start + size;
+    allocation.offset = (GLintptr)(regionSize * region + start);
+
+    glBindBuffer(target, buffer.get());
+    if (persistentData) {
+        allocation.data = persistentData + allocation.offset;
+    } else {
+        // The fences already keep the GPU off this range, so the driver need not synchronize
+        allocation.data = glMapBufferRange(target, allocation.offset, (GLsizeiptr)size,
+                                           GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        mapped = allocation.data != nullptr;
+        if (!mapped) {
+            allocation.offset = -1;
+        }
+    }
+    return allocation;
+}
+
+void StreamBuffer::commit() {
+    // Coherent persistent writes are visible to commands issued after them
+    if (!mapped) {
+        return;
+    }
+    glBindBuffer(target, buffer.get());
+    glUnmapBuffer(target);
+    mapped = false;
+}
+
+void StreamBuffer::endFrame() {
+    if (fences.empty()) {
+        return;
+    }
+    commit();
+    if (fences[region]) {
+        glDeleteSync(fences[region]);
+    }
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLintptr StreamBuffer::write(const void* data, size_t size, size_t alignment) {
+    StreamAllocation allocation = allocate(size, alignment);
+    if (!allocation.data) {
+        return -1;
+    }
+    std::memcpy(allocation.data, data, size);
+    commit();
+    return allocation.offset;
+}
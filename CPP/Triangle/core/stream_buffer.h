@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_objects.h"
+
+// How a StreamBuffer hands out memory the CPU writes into
+enum class StreamMapping {
+    Auto,            // Persistent when the driver has buffer storage, otherwise Unsynchronized
+    Persistent,      // one coherent mapping for the buffer's lifetime (GL 4.4 / ARB_buffer_storage)
+    Unsynchronized   // glMapBufferRange per allocation, unsynchronized + invalidate range (GL 3.3)
+};
+
+// Where an allocation's data goes. data is null when the region is full.
+struct StreamAllocation {
+    void* data;
+    GLintptr offset;   // byte offset in the buffer: attribute pointer, draw base or glBindBufferRange offset
+};
+
+// Streams data that changes every frame (dynamic vertices, per-draw uniform
+// blocks) to the GPU without the driver stalling on a buffer still in use.
+//
+// One buffer is split into regionCount regions and each frame writes into the
+// next one. endFrame() drops a fence behind the frame's draws, and
+// beginFrame() only waits on it when the GPU is still reading the region from
+// regionCount frames ago, so with 3 regions the CPU can run two frames ahead.
+// Because the fences already guarantee the GPU is done with a region, the
+// driver never has to synchronize: the buffer is either mapped once for good
+// (Persistent) or each allocation is mapped with GL_MAP_UNSYNCHRONIZED_BIT.
+//
+//   stream.beginFrame();
+//   StreamAllocation vertices = stream.allocate(bytes);
+//   ...write bytes to vertices.data...
+//   stream.commit();
+//   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void*)vertices.offset);
+//   glDrawArrays(...);
+//   stream.endFrame();
+class StreamBuffer {
+private:
+    GLBuffer buffer;
+    GLenum target;
+    StreamMapping mapping;     // as resolved by create(), never Auto
+    size_t regionSize;
+    size_t minAlignment;
+    std::vector<GLsync> fences;
+    int region;
+    size_t offset;             // next free byte in the current region
+    unsigned char* persistentData;
+    bool mapped;               // Unsynchronized: an allocation is waiting for commit()
+    int waitCount;
+
+public:
+    StreamBuffer();
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // target is the binding the data is used through (GL_ARRAY_BUFFER,
+    // GL_UNIFORM_BUFFER, ...); uniform buffers align every allocation to
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    bool create(GLenum target, size_t regionSize, int regionCount = 3, StreamMapping mapping = StreamMapping::Auto);
+    void destroy();
+
+    // Moves to the next region, first waiting for the GPU to finish the frame
+    // that last used it (counted in getWaitCount())
+    void beginFrame();
+    // size bytes in the current region, at an offset that is a multiple of
+    // alignment (a power of two). Leaves the buffer bound to the target.
+    StreamAllocation allocate(size_t size, size_t alignment = 16);
+    // Makes what was written since allocate() visible to the GPU; call before
+    // the draw that reads it
+    void commit();
+    // Fences the current region; call after the frame's last draw that reads it
+    void endFrame();
+
+    // allocate() + copy + commit(); -1 when the region is full
+    GLintptr write(const void* data, size_t size, size_t alignment = 16);
+
+    GLuint get() const { return buffer.get(); }
+    StreamMapping getMapping() const { return mapping; }
+    size_t getRegionSize() const { return regionSize; }
+    int getRegionCount() const { return (int)fences.size(); }
+    // Frames that found their region still in use by the GPU
+    int getWaitCount() const { return waitCount; }
+};
+
+const char* streamMappingName(StreamMapping mapping);
@@ -0,0 +1,238 @@
+#include "texture_loader.h"
+
+#include <algorithm>
+#include <iostream>
+#include "image_reader.h"
+#include "stb_image.h"
+#include "texture_upload.h"
+#include "trace.h"
+
+AsyncTextureLoader::AsyncTextureLoader() : uploadBudget(kDefaultUploadBudget) {}
+
+AsyncTextureLoader::~AsyncTextureLoader() {
+    destroy();
+}
+
+bool AsyncTextureLoader::create(int decodeThreads, size_t budget, const MipOptions& mips) {
+    destroy();
+    pool.reset(new ThreadPool(decodeThreads));
+    uploadBudget = budget;
+    mipOptions = mips;
+    return true;
+}
+
+void AsyncTextureLoader::destroy() {
+    // Joins the threads first, so no task still uses a job or a mapped buffer
+    pool.reset();
+    for (auto& job : jobs) {
+        releaseJob(*job);
+    }
+    jobs.clear();
+    failedTextures.clear();
+}
+
+void AsyncTextureLoader::releaseJob(Job& job) {
+    if (job.pixelBuffer) {
+        if (job.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pixelBuffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            job.mapped = nullptr;
+        }
+        glDeleteBuffers(1, &job.pixelBuffer);
+        job.pixelBuffer = 0;
+    }
+    if (job.pixels) {
+        stbi_image_free(job.pixels);
+        job.pixels = nullptr;
+    }
+    job.mips.clear();
+}
+
+size_t AsyncTextureLoader::getJobSize(const Job& job) {
+    size_t size = 0;
+    int levelCount = mipLevelCount(job.width, job.height);
+    for (int level = 0; level < levelCount; level++) {
+        size += getUploadSize(std::max(job.width >> level, 1), std::max(job.height >> level, 1), job.channels);
+    }
+    return size;
+}
+
+GLuint AsyncTextureLoader::request(const std::string& path, bool flipVertically) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // Mid grey until the real image arrives; a 1x1 level is a complete mip
+    // chain on its own, so any min filter can sample it
+    const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->path = path;
+    job->flipVertically = flipVertically;
+    job->texture = texture;
+    job->state = JobState::Decoding;
+    job->pixels = nullptr;
+    job->width = job->height = job->channels = 0;
+    job->pixelBuffer = 0;
+    job->mapped = nullptr;
+    job->requested = std::chrono::steady_clock::now();
+    jobs.push_back(job);
+
+    if (!pool) {
+        pool.reset(new ThreadPool());
+    }
+    pool->submit([this, job] { decode(*job); });
+    return texture;
+}
+
+void AsyncTextureLoader::decode(Job& job) {
+    TraceZone zone("decode image", "texture");
+    job.pixels = loadImageFile(job.path, job.width, job.height, job.channels, 0, job.flipVertically, job.error);
+    if (!job.pixels) {
+        job.state = JobState::Failed;
+        return;
+    }
+    if (!buildMipChain(job.pixels, job.width, job.height, job.channels, mipOptions, job.mips)) {
+        job.error = "unsupported channel count";
+        job.state = JobState::Failed;
+        return;
+    }
+    job.state = JobState::Decoded;
+}
+
+bool AsyncTextureLoader::startCopy(const std::shared_ptr<Job>& job) {
+    TraceZone zone("map pixel buffer", "texture");
+    GLsizeiptr size = (GLsizeiptr)getJobSize(*job);
+
+    glGenBuffers(1, &job->pixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job->pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    job->mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!job->mapped) {
+        glDeleteBuffers(1, &job->pixelBuffer);
+        job->pixelBuffer = 0;
+        return false;
+    }
+
+    // Mapped memory may be written from any thread; only map/unmap need the context
+    job->state = JobState::Copying;
+    // Levels go in order, each converted to its upload layout (see texture_upload.h)
+    pool->submit([job] {
+        TraceZone zone("copy to pixel buffer", "texture");
+        unsigned char* out = (unsigned char*)job->mapped;
+        int levelCount = mipLevelCount(job->width, job->height);
+        for (int level = 0; level < levelCount; level++) {
+            int width = std::max(job->width >> level, 1), height = std::max(job->height >> level, 1);
+            const unsigned char* pixels = level == 0 ? job->pixels : job->mips[level - 1].data();
+            convertForUpload(pixels, width, height, job->channels, out);
+            out += getUploadSize(width, height, job->channels);
+        }
+        stbi_image_free(job->pixels);
+        job->pixels = nullptr;
+        job->mips.clear();
+        job->state = JobState::Copied;
+    });
+    return true;
+}
+
+void AsyncTextureLoader::finishUpload(Job& job) {
+    TraceZone zone("upload texture", "texture");
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+    if (job.pixelBuffer) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pixelBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        job.mapped = nullptr;
+    }
+
+    // The PBO holds the levels back to back in their converted layout; without
+    // one the decoded (tightly packed) pixels are uploaded directly
+    int levelCount = mipLevelCount(job.width, job.height);
+    size_t offset = 0;
+    for (int level = 0; level < levelCount; level++) {
+        int width = std::max(job.width >> level, 1), height = std::max(job.height >> level, 1);
+        if (job.pixelBuffer) {
+            uploadConvertedTexImage2D(level, width, height, job.channels, (const void*)offset);
+            offset += getUploadSize(width, height, job.channels);
+        } else {
+            uploadTexImage2D(level, width, height, job.channels, level == 0 ? job.pixels : job.mips[level - 1].data());
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    // Grey (and grey + alpha) images sample as grey rather than red
+    if (job.channels <= 2) {
+        GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, job.channels == 2 ? GL_GREEN : GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    if (job.pixelBuffer) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    releaseJob(job);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.requested).count();
+    std::cout << "Loaded " << job.path << ": " << job.width << "x" << job.height << " channels: " << job.channels
+              << ", " << levelCount << " levels (ready after " << ms << " ms)" << std::endl;
+}
+
+void AsyncTextureLoader::update() {
+    size_t budgetLeft = uploadBudget;
+    bool first = true;
+
+    for (size_t i = 0; i < jobs.size();) {
+        std::shared_ptr<Job> job = jobs[i];
+        JobState state = job->state;
+
+        if (state == JobState::Decoded) {
+            size_t size = getJobSize(*job);
+            if (first || size <= budgetLeft) {
+                budgetLeft -= std::min(size, budgetLeft);
+                first = false;
+                // Without a mappable buffer, upload straight from the decoded pixels
+                if (!startCopy(job)) {
+                    finishUpload(*job);
+                    jobs.erase(jobs.begin() + i);
+                    continue;
+                }
+            }
+        } else if (state == JobState::Copied) {
+            finishUpload(*job);
+            jobs.erase(jobs.begin() + i);
+            continue;
+        } else if (state == JobState::Failed) {
+            std::cerr << "Failed to load " << job->path << ": " << job->error << std::endl;
+            failedTextures.push_back(job->texture);
+            releaseJob(*job);
+            jobs.erase(jobs.begin() + i);
+            continue;
+        }
+        i++;
+    }
+}
+
+bool AsyncTextureLoader::isPending(GLuint texture) const {
+    for (const auto& job : jobs) {
+        if (job->texture == texture) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<GLuint> AsyncTextureLoader::takeFailed() {
+    std::vector<GLuint> failed;
+    failed.swap(failedTextures);
+    return failed;
+}
+
+void AsyncTextureLoader::finish() {
+    while (!jobs.empty()) {
+        update();
+        if (!jobs.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
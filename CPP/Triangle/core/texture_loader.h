@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "mip_builder.h"
+#include "thread_pool.h"
+
+// Loads image files into GL textures without blocking the render thread.
+//
+// request() returns a texture right away, holding a 1x1 placeholder texel, and
+// queues the file on a decode thread pool. update(), called once per frame on
+// the GL thread, moves finished decodes through a pixel unpack buffer:
+//   1. decode thread: stb_image decodes the file (memory-mapped, see
+//                     loadImageFile()) and the mip chain is built
+//                     (see buildMipChain());
+//   2. GL thread:     a PBO is allocated and mapped;
+//   3. pool thread:   every level is converted into the mapped PBO (RGB
+//                     expanded to RGBA, rows 4-byte aligned; see texture_upload.h);
+//   4. GL thread:     unmap, one glTexImage2D per level from the PBO.
+// The GL thread never touches pixel data, so frames stay short however large
+// the image, and any number of files decode concurrently. The texture object
+// keeps its name, so whatever holds it starts drawing the real image as soon
+// as step 4 has run.
+// Bytes moved into pixel buffers per update() unless create() says otherwise
+constexpr size_t kDefaultUploadBudget = 32u << 20;
+
+class AsyncTextureLoader {
+private:
+    enum class JobState { Decoding, Decoded, Copying, Copied, Failed };
+
+    struct Job {
+        std::string path;
+        bool flipVertically;
+        GLuint texture;
+        std::atomic<JobState> state;
+        unsigned char* pixels;
+        int width, height, channels;
+        std::vector<std::vector<unsigned char>> mips;
+        std::string error;
+        GLuint pixelBuffer;
+        void* mapped;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<std::shared_ptr<Job>> jobs;
+    std::vector<GLuint> failedTextures;
+    size_t uploadBudget;
+    MipOptions mipOptions;
+
+    void decode(Job& job);
+    bool startCopy(const std::shared_ptr<Job>& job);
+    void finishUpload(Job& job);
+    void releaseJob(Job& job);
+    static size_t getJobSize(const Job& job);
+
+public:
+    // Usable without create(): request() starts the default thread pool
+    AsyncTextureLoader();
+    ~AsyncTextureLoader();
+
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+    // decodeThreads: 0 = hardware threads minus one. uploadBudget caps the
+    // bytes moved into pixel buffers per update() (at least one image always goes).
+    // mipOptions sets how the mip levels are filtered.
+    bool create(int decodeThreads = 0, size_t uploadBudget = kDefaultUploadBudget, const MipOptions& mipOptions = MipOptions());
+    void destroy();
+
+    // Returns a new texture (owned by the caller) showing the placeholder until
+    // the file is loaded. Leaves it bound to GL_TEXTURE_2D on the active unit.
+    GLuint request(const std::string& path, bool flipVertically = true);
+
+    // Advances the pipeline; changes the GL_TEXTURE_2D binding of the active unit
+    void update();
+
+    // Blocks until every requested texture is loaded or has failed
+    void finish();
+
+    size_t pendingCount() const { return jobs.size(); }
+    // Whether a texture from request() is still waiting for its image
+    bool isPending(GLuint texture) const;
+    // Textures whose file failed to load since the last call; they keep the placeholder
+    std::vector<GLuint> takeFailed();
+};
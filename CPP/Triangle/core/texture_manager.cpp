@@ -0,0 +1,204 @@
+#include "texture_manager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "ktx_texture.h"
+#include "trace.h"
+
+// Video memory of every level of the texture bound to GL_TEXTURE_2D, as the
+// driver reports it (a driver may still pad, e.g. store RGB8 as RGBA8)
+static size_t getBoundTextureSize() {
+    size_t total = 0;
+    for (int level = 0; level < 32; level++) {
+        GLint width = 0, height = 0, compressed = GL_FALSE;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+        if (width == 0 || height == 0) {
+            break;
+        }
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &compressed);
+        if (compressed) {
+            GLint size = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            total += (size_t)size;
+            continue;
+        }
+        GLint bits = 0;
+        for (GLenum component : { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE }) {
+            GLint componentBits = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, component, &componentBits);
+            bits += componentBits;
+        }
+        total += (size_t)width * height * bits / 8;
+    }
+    return total;
+}
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = std::char_traits<char>::length(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+TextureManager::TextureManager() {
+    stats.budgetBytes = (size_t)256 << 20;
+}
+
+TextureManager::~TextureManager() {
+    // Without a context nothing can be deleted; clear() is the normal way out
+    for (auto& entry : entries) {
+        entry->texture.release();
+    }
+}
+
+void TextureManager::setBudget(size_t bytes) {
+    stats.budgetBytes = bytes;
+    trim();
+}
+
+std::shared_ptr<ManagedTexture> TextureManager::load(const std::string& path) {
+    std::shared_ptr<ManagedTexture> entry = std::make_shared<ManagedTexture>();
+    entry->path = path;
+    if (endsWith(path, ".ktx2")) {
+        entry->texture.reset(loadKtx2Texture(path));
+        if (!entry->texture) {
+            return nullptr;
+        }
+        entry->bytes = getBoundTextureSize();
+    } else {
+        // A missing file fails here; one that does not decode fails in update()
+        if (!std::ifstream(path).good()) {
+            std::cerr << "Failed to open " << path << std::endl;
+            return nullptr;
+        }
+        entry->texture.reset(loader.request(path));
+        entry->loading = true;
+    }
+
+    // Sampling state is part of the shared texture, so it is set once here and
+    // never by the renderers. Both loaders upload a full mip chain.
+    glBindTexture(GL_TEXTURE_2D, entry->get());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return entry;
+}
+
+TextureHandle TextureManager::acquire(const std::string& path) {
+    TraceZone zone("acquire texture", "texture");
+    auto found = index.find(path);
+    if (found != index.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        stats.hits++;
+        traceStats();
+        glBindTexture(GL_TEXTURE_2D, entries.front()->get());
+        return entries.front();
+    }
+
+    stats.misses++;
+    std::shared_ptr<ManagedTexture> entry = load(path);
+    if (!entry) {
+        traceStats();
+        return nullptr;
+    }
+    entries.push_front(entry);
+    index[path] = entries.begin();
+    stats.residentBytes += entry->bytes;
+    stats.residentTextures++;
+    trim();
+    traceStats();
+    glBindTexture(GL_TEXTURE_2D, entry->get());
+    return entry;
+}
+
+void TextureManager::update() {
+    loader.update();
+    std::vector<GLuint> failed = loader.takeFailed();
+    bool changed = false;
+    for (auto it = entries.begin(); it != entries.end();) {
+        ManagedTexture& entry = **it;
+        if (!entry.loading || loader.isPending(entry.get())) {
+            ++it;
+            continue;
+        }
+        entry.loading = false;
+        changed = true;
+        if (std::find(failed.begin(), failed.end(), entry.get()) != failed.end()) {
+            // Holders keep the placeholder; the next acquire() loads the file again
+            entry.failed = true;
+            stats.residentTextures--;
+            index.erase(entry.path);
+            it = entries.erase(it);
+            continue;
+        }
+        glBindTexture(GL_TEXTURE_2D, entry.get());
+        entry.bytes = getBoundTextureSize();
+        stats.residentBytes += entry.bytes;
+        ++it;
+    }
+    if (changed) {
+        trim();
+        traceStats();
+    }
+}
+
+void TextureManager::finish() {
+    loader.finish();
+    update();
+}
+
+void TextureManager::trim() {
+    // Oldest first; a texture with a handle outside the cache stays
+    for (auto it = entries.end(); it != entries.begin() && stats.residentBytes > stats.budgetBytes;) {
+        --it;
+        const std::shared_ptr<ManagedTexture>& entry = *it;
+        if (entry.use_count() > 1 || entry->loading) {
+            continue;
+        }
+        stats.residentBytes -= entry->bytes;
+        stats.residentTextures--;
+        stats.evictions++;
+        index.erase(entry->path);
+        it = entries.erase(it);
+    }
+}
+
+void TextureManager::evictUnused() {
+    size_t budget = stats.budgetBytes;
+    stats.budgetBytes = 0;
+    trim();
+    stats.budgetBytes = budget;
+    traceStats();
+}
+
+void TextureManager::clear() {
+    loader.destroy();
+    entries.clear();
+    index.clear();
+    size_t budget = stats.budgetBytes;
+    stats = TextureCacheStats();
+    stats.budgetBytes = budget;
+}
+
+void TextureManager::addContextUser() {
+    contextUsers++;
+}
+
+void TextureManager::releaseContextUser() {
+    if (contextUsers > 0 && --contextUsers == 0) {
+        clear();
+    }
+}
+
+void TextureManager::traceStats() const {
+    traceCounter("texture cache hits", (int64_t)stats.hits);
+    traceCounter("texture cache misses", (int64_t)stats.misses);
+    traceCounter("texture cache evictions", (int64_t)stats.evictions);
+    traceCounter("texture cache KiB", (int64_t)(stats.residentBytes / 1024));
+}
+
+TextureManager& getTextureManager() {
+    static TextureManager manager;
+    return manager;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "gl_objects.h"
+#include "texture_loader.h"
+
+// A texture owned by the TextureManager and shared by everyone who acquired it
+class ManagedTexture {
+private:
+    friend class TextureManager;
+
+    GLTexture texture;
+    std::string path;
+    size_t bytes = 0;       // as the driver reports it, once loaded
+    bool loading = false;   // still being decoded by the manager's loader
+    bool failed = false;    // the file did not decode; the placeholder stays
+
+public:
+    GLuint get() const { return texture.get(); }
+    const std::string& getPath() const { return path; }
+    size_t getBytes() const { return bytes; }
+    bool isLoaded() const { return !loading && !failed; }
+    bool hasFailed() const { return failed; }
+};
+
+// A counted reference: the texture cannot be evicted while one is held
+using TextureHandle = std::shared_ptr<const ManagedTexture>;
+
+struct TextureCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    int residentTextures = 0;
+};
+
+// Process-wide cache of textures loaded from files, so renderers that show
+// the same image share one decode and one copy in video memory.
+//
+//   TextureHandle rose = getTextureManager().acquire("rose.png");
+//   glBindTexture(GL_TEXTURE_2D, rose->get());
+//
+// Textures stay cached after the last handle is dropped and are evicted,
+// least recently acquired first, only when the resident total exceeds the
+// budget; textures still held are never evicted, so the budget is exceeded
+// rather than deleting something in use. KTX2 files load synchronously;
+// other images load through an AsyncTextureLoader and show its placeholder
+// until update() has finished them. An image that then fails to decode is
+// marked hasFailed(), keeps the placeholder and leaves the cache, so the
+// next acquire() of its path tries the file again.
+//
+// Every texture is set up once for repeat wrapping and trilinear filtering.
+// The texture object is shared, so a renderer that needs other sampling
+// state binds its own sampler object instead of changing it.
+//
+// Hits, misses, evictions and resident bytes are printed at the end of a
+// demo run, added to the benchmark JSON and recorded as trace counters.
+//
+// GL thread only. The DemoApps of a process all have contexts in one share
+// group (see GLContext), so a cached texture name is valid in each of them.
+// Every DemoApp registers as a context user; the cache is cleared when the
+// last one goes, before it destroys its context, so tearing down one
+// renderer leaves the others' textures and loads alone.
+class TextureManager {
+private:
+    // Front is the most recently acquired
+    std::list<std::shared_ptr<ManagedTexture>> entries;
+    std::unordered_map<std::string, std::list<std::shared_ptr<ManagedTexture>>::iterator> index;
+    AsyncTextureLoader loader;
+    TextureCacheStats stats;
+    int contextUsers = 0;
+
+    std::shared_ptr<ManagedTexture> load(const std::string& path);
+    void trim();
+    void traceStats() const;
+
+public:
+    TextureManager();
+    ~TextureManager();
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    void setBudget(size_t bytes);
+
+    // The cached texture for `path`, or a newly loaded one (image rows flipped
+    // for GL, like everywhere in the demos). Null if the file cannot be opened
+    // or, for KTX2, loaded; a decode failure of another image shows up later
+    // as hasFailed(). Leaves the texture bound to GL_TEXTURE_2D on the active unit.
+    TextureHandle acquire(const std::string& path);
+
+    // Advances the loads in flight and evicts over budget; call once per frame.
+    // Changes the GL_TEXTURE_2D binding of the active unit.
+    void update();
+
+    // Blocks until every image load has finished
+    void finish();
+
+    // Evicts every texture no handle holds
+    void evictUnused();
+
+    // Deletes every cached texture (held ones go with their last handle) and
+    // resets the counters; the context must still be current
+    void clear();
+
+    // Counts the owners of the context the textures live in. Releasing the
+    // last one clear()s the cache, so call it while the context is current.
+    void addContextUser();
+    void releaseContextUser();
+
+    const TextureCacheStats& getStats() const { return stats; }
+};
+
+TextureManager& getTextureManager();
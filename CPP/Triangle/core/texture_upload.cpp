@@ -0,0 +1,65 @@
+#include "texture_upload.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "upload_kernels.h"
+
+UploadFormat getUploadFormat(int channels) {
+    switch (channels) {
+    case 1:
+        return { GL_RED, 1 };
+    case 2:
+        return { GL_RG, 2 };
+    default:
+        return { GL_RGBA, 4 };
+    }
+}
+
+size_t getUploadRowPitch(int width, int channels) {
+    size_t rowSize = (size_t)width * getUploadFormat(channels).bytesPerPixel;
+    return (rowSize + 3) & ~(size_t)3;
+}
+
+size_t getUploadSize(int width, int height, int channels) {
+    return getUploadRowPitch(width, channels) * height;
+}
+
+void convertForUpload(const unsigned char* pixels, int width, int height, int channels, unsigned char* dst,
+                      SimdLevel maxSimd) {
+    size_t pitch = getUploadRowPitch(width, channels);
+    size_t rowSize = (size_t)width * channels;
+    if (channels == 3) {
+        // RGBA rows are always aligned, so the whole image is one run
+        getExpandRgbKernel(std::min(detectSimdLevel(), maxSimd))(pixels, dst, (size_t)width * height);
+    } else if (pitch == rowSize) {
+        std::memcpy(dst, pixels, rowSize * height);
+    } else {
+        for (int y = 0; y < height; y++) {
+            std::memcpy(dst + pitch * y, pixels + rowSize * y, rowSize);
+            std::memset(dst + pitch * y + rowSize, 0, pitch - rowSize);
+        }
+    }
+}
+
+void uploadTexImage2D(int level, int width, int height, int channels, const unsigned char* pixels) {
+    if (channels == 3) {
+        std::vector<unsigned char> rgba(getUploadSize(width, height, channels));
+        convertForUpload(pixels, width, height, channels, rgba.data());
+        uploadConvertedTexImage2D(level, width, height, channels, rgba.data());
+        return;
+    }
+
+    // Tight rows are read in place rather than copied to padded ones
+    GLenum format = getUploadFormat(channels).format;
+    bool aligned = (size_t)width * channels % 4 == 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, aligned ? 4 : 1);
+    glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void uploadConvertedTexImage2D(int level, int width, int height, int channels, const void* data) {
+    GLenum format = getUploadFormat(channels).format;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+}
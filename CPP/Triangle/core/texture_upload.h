@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+#include "softraster/cpu_features.h"
+
+// Puts 8-bit images into the layout drivers take without a conversion pass:
+// RGB is expanded to RGBA (three-byte texels are swizzled by the driver on
+// the CPU, byte by byte, on most implementations), and every row starts on a
+// 4-byte boundary, which is what the default GL_UNPACK_ALIGNMENT assumes.
+// One and two channel images stay as they are, with padded rows.
+
+struct UploadFormat {
+    GLenum format;          // glTexImage2D format and internal format
+    int bytesPerPixel;      // after conversion
+};
+
+UploadFormat getUploadFormat(int channels);
+
+// Bytes from one row of the converted image to the next (a multiple of 4)
+size_t getUploadRowPitch(int width, int channels);
+
+// Size of the converted image
+size_t getUploadSize(int width, int height, int channels);
+
+// Converts tightly packed pixels (1-4 channels) into dst, which holds
+// getUploadSize() bytes; dst may be mapped buffer memory. maxSimd caps the
+// expansion kernel (see getExpandRgbKernel()).
+void convertForUpload(const unsigned char* pixels, int width, int height, int channels, unsigned char* dst,
+                      SimdLevel maxSimd = SimdLevel::AVX2);
+
+// glTexImage2D of tightly packed pixels from client memory into the texture
+// bound to GL_TEXTURE_2D. RGB goes through a temporary RGBA copy; rows that
+// are not 4-byte aligned are uploaded with GL_UNPACK_ALIGNMENT 1.
+void uploadTexImage2D(int level, int width, int height, int channels, const unsigned char* pixels);
+
+// glTexImage2D of an image already produced by convertForUpload(). `data` is
+// an offset when a GL_PIXEL_UNPACK_BUFFER is bound.
+void uploadConvertedTexImage2D(int level, int width, int height, int channels, const void* data);
@@ -0,0 +1,51 @@
+#include "thread_pool.h"
+#include "trace.h"
+
+ThreadPool::ThreadPool(int threadCount) : stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency() - 1;
+    }
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::workerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        tasks.clear();
+    }
+    condition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::workerMain() {
+    setTraceThreadName("pool worker");
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
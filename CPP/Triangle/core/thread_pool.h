@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Background threads that run queued tasks in submission order. Destroying
+// the pool waits for running tasks and drops the ones that have not started.
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> tasks;
+    bool stopping;
+
+    void workerMain();
+
+public:
+    // 0 = one thread per hardware thread, minus one for the render thread
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return (int)threads.size(); }
+
+    void submit(std::function<void()> task);
+};
@@ -0,0 +1,212 @@
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+enum class EventKind { Cpu, Gpu, Counter };
+
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t start;
+    int64_t duration;  // the value, for counters
+    EventKind kind;
+};
+
+const size_t kChunkEvents = 4096;
+
+struct Chunk {
+    Event events[kChunkEvents];
+    std::atomic<size_t> count{0};
+    std::atomic<Chunk*> next{nullptr};
+};
+
+// Written only by its thread; read by stopTrace()
+struct ThreadBuffer {
+    int id;
+    std::atomic<const char*> name{nullptr};
+    Chunk* first;
+    Chunk* last;
+};
+
+std::atomic<bool> enabled{false};
+std::atomic<uint32_t> generation{0};
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+std::vector<std::unique_ptr<Chunk>> chunks;
+std::string tracePath;
+int64_t traceStart = 0;
+
+struct ThreadState {
+    ThreadBuffer* buffer = nullptr;
+    uint32_t generation = 0;
+    const char* name = nullptr;
+};
+thread_local ThreadState threadState;
+
+ThreadBuffer* threadBuffer() {
+    uint32_t current = generation.load(std::memory_order_acquire);
+    if (threadState.buffer && threadState.generation == current) {
+        return threadState.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    buffer->id = (int)buffers.size() + 1;
+    buffer->name.store(threadState.name, std::memory_order_relaxed);
+    buffer->first = buffer->last = chunk.get();
+    chunks.push_back(std::move(chunk));
+    buffers.push_back(std::move(buffer));
+
+    threadState.buffer = buffers.back().get();
+    threadState.generation = current;
+    return threadState.buffer;
+}
+
+Chunk* newChunk() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    chunks.emplace_back(new Chunk());
+    return chunks.back().get();
+}
+
+void record(const Event& event) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadBuffer* buffer = threadBuffer();
+    Chunk* chunk = buffer->last;
+    size_t count = chunk->count.load(std::memory_order_relaxed);
+    if (count == kChunkEvents) {
+        Chunk* next = newChunk();
+        chunk->next.store(next, std::memory_order_release);
+        buffer->last = chunk = next;
+        count = 0;
+    }
+    chunk->events[count] = event;
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+}  // namespace
+
+void writeJsonString(std::ostream& out, const char* text) {
+    static const char hex[] = "0123456789abcdef";
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch == '"' || ch == '\\') {
+            out << '\\' << *c;
+        } else if (ch < 0x20) {
+            out << "\\u00" << hex[ch >> 4] << hex[ch & 0xf];
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool startTrace(const std::string& path) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffers.clear();
+    chunks.clear();
+    generation.fetch_add(1, std::memory_order_release);
+    tracePath = path;
+    traceStart = traceNow();
+    enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+bool isTraceEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void setTraceThreadName(const char* name) {
+    threadState.name = name;
+    if (threadState.buffer && threadState.generation == generation.load(std::memory_order_acquire)) {
+        threadState.buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void traceEvent(const char* name, const char* category, int64_t startNs, int64_t durationNs) {
+    record({ name, category, startNs, durationNs, EventKind::Cpu });
+}
+
+void traceGpuEvent(const char* name, int64_t startNs, int64_t durationNs) {
+    record({ name, "gpu", startNs, durationNs, EventKind::Gpu });
+}
+
+void traceCounter(const char* name, int64_t value) {
+    if (isTraceEnabled()) {
+        record({ name, "counter", traceNow(), value, EventKind::Counter });
+    }
+}
+
+bool stopTrace() {
+    if (!enabled.exchange(false)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::ofstream out(tracePath);
+    if (!out) {
+        std::cerr << "Failed to write trace to " << tracePath << std::endl;
+        return false;
+    }
+
+    // Timestamps in microseconds since startTrace(); the GPU gets its own track
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    const int gpuTrack = 0;
+    size_t eventCount = 0;
+    bool hasGpuEvents = false;
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"triangle\"}}";
+    for (const auto& buffer : buffers) {
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        if (name) {
+            out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id << ", \"args\": {\"name\": ";
+            writeJsonString(out, name);
+            out << "}}";
+        }
+        for (Chunk* chunk = buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            size_t count = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const Event& event = chunk->events[i];
+                bool gpu = event.kind == EventKind::Gpu;
+                out << ",\n{\"name\": ";
+                writeJsonString(out, event.name);
+                out << ", \"cat\": ";
+                writeJsonString(out, event.category);
+                if (event.kind == EventKind::Counter) {
+                    // Counters are drawn per process, whichever thread set them
+                    out << ", \"ph\": \"C\", \"pid\": 1, \"ts\": " << (event.start - traceStart) / 1000.0
+                        << ", \"args\": {\"value\": " << event.duration << "}}";
+                } else {
+                    out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << (gpu ? gpuTrack : buffer->id)
+                        << ", \"ts\": " << (event.start - traceStart) / 1000.0
+                        << ", \"dur\": " << event.duration / 1000.0 << "}";
+                }
+                hasGpuEvents = hasGpuEvents || gpu;
+                eventCount++;
+            }
+        }
+    }
+    if (hasGpuEvents) {
+        out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << gpuTrack << ", \"args\": {\"name\": \"GPU\"}}";
+    }
+    out << "\n]}\n";
+
+    std::cout << "Trace written to " << tracePath << " (" << eventCount << " events)" << std::endl;
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Chrome trace-event recorder (chrome://tracing, ui.perfetto.dev).
+//
+// Each thread appends complete ("X") events to its own chunked buffer. The
+// chunks never move and each publishes its event count with a release store,
+// so recording takes no lock and no allocation outside a new chunk every few
+// thousand events. A mutex is taken once per thread, to register its buffer.
+//
+//   startTrace("trace.json");
+//   { TraceZone zone("render"); ... }
+//   stopTrace();   // writes the file
+//
+// Event names and categories must be string literals (or otherwise outlive
+// the trace). While no trace is running a TraceZone costs one atomic load.
+// startTrace() and stopTrace() bracket a whole run: call them while no other
+// thread is recording.
+
+// Steady clock in nanoseconds, the time base of all events
+int64_t traceNow();
+
+bool startTrace(const std::string& path);
+// Writes every recorded event; false if the file cannot be written
+bool stopTrace();
+bool isTraceEnabled();
+
+// Shown as the track name of the calling thread
+void setTraceThreadName(const char* name);
+
+void traceEvent(const char* name, const char* category, int64_t startNs, int64_t durationNs);
+// Same, on a separate "GPU" track (times already converted to traceNow())
+void traceGpuEvent(const char* name, int64_t startNs, int64_t durationNs);
+// Value of a named counter from now on, drawn as a graph ("C" event)
+void traceCounter(const char* name, int64_t value);
+
+// Writes text as a quoted, escaped JSON string (the frame-stats report uses it too)
+void writeJsonString(std::ostream& out, const char* text);
+
+class TraceZone {
+private:
+    const char* name;
+    const char* category;
+    int64_t start;
+
+public:
+    explicit TraceZone(const char* name, const char* category = "cpu")
+        : name(name), category(category), start(isTraceEnabled() ? traceNow() : -1) {}
+    ~TraceZone() {
+        if (start >= 0) {
+            traceEvent(name, category, start, traceNow() - start);
+        }
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+};
@@ -0,0 +1,24 @@
+#include "upload_kernels.h"
+
+ExpandRgbKernel getExpandRgbKernel(SimdLevel level) {
+#ifdef TRIANGLE_X86_KERNELS
+    if (level >= SimdLevel::AVX2) {
+        return expandRgbAvx2;
+    }
+    if (level >= SimdLevel::SSE41) {
+        return expandRgbSse41;
+    }
+#else
+    (void)level;
+#endif
+    return expandRgbScalar;
+}
+
+void expandRgbScalar(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount) {
+    for (size_t i = 0; i < pixelCount; i++) {
+        rgba[i * 4] = rgb[i * 3];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+}
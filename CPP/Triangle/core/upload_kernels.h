@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include "softraster/cpu_features.h"
+
+// RGB8 -> RGBA8 with alpha 255, for texture uploads (texture_upload.cpp).
+// Source and destination must not overlap.
+using ExpandRgbKernel = void (*)(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount);
+
+// Kernel for the given level, or for the best level below it that this build has
+ExpandRgbKernel getExpandRgbKernel(SimdLevel level);
+
+void expandRgbScalar(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount);
+#ifdef TRIANGLE_X86_KERNELS
+// Defined in translation units built with -msse4.1 and -mavx2 -mfma; only
+// call them after checking detectSimdLevel()
+void expandRgbSse41(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount);
+void expandRgbAvx2(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount);
+#endif
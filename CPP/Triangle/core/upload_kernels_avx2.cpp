@@ -0,0 +1,32 @@
+// Built with -mavx2 -mfma; only reached through getExpandRgbKernel()
+#include "upload_kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+// Eight pixels: the byte shuffle works within 128-bit lanes, so each lane is
+// loaded with its own four pixels (12 of the 16 bytes read are used)
+inline __m256i expandEight(const unsigned char* in, __m256i spread, __m256i alpha) {
+    __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)in)),
+                                             _mm_loadu_si128((const __m128i*)(in + 12)), 1);
+    return _mm256_or_si256(_mm256_shuffle_epi8(pixels, spread), alpha);
+}
+
+}
+
+void expandRgbAvx2(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount) {
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000u);
+    size_t i = 0;
+    // The last load of an iteration reads 4 bytes past its 16 pixels, so stop
+    // while two more pixels remain and leave the rest to the scalar loop
+    for (; i + 18 <= pixelCount; i += 16) {
+        const unsigned char* in = rgb + i * 3;
+        __m256i* out = (__m256i*)(rgba + i * 4);
+        _mm256_storeu_si256(out, expandEight(in, spread, alpha));
+        _mm256_storeu_si256(out + 1, expandEight(in + 24, spread, alpha));
+    }
+    expandRgbScalar(rgb + i * 3, rgba + i * 4, pixelCount - i);
+}
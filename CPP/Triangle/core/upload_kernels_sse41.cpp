@@ -0,0 +1,26 @@
+// Built with -msse4.1; only reached through getExpandRgbKernel()
+#include "upload_kernels.h"
+
+#include <smmintrin.h>
+
+// 16 pixels per iteration: three 16-byte loads hold 48 bytes of RGB; each
+// group of four pixels (12 bytes) is shifted into place and spread out to
+// 16 bytes with a byte shuffle, and the alpha bytes are or'ed in
+void expandRgbSse41(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount) {
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000u);
+    size_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16) {
+        const unsigned char* in = rgb + i * 3;
+        __m128i in0 = _mm_loadu_si128((const __m128i*)in);
+        __m128i in1 = _mm_loadu_si128((const __m128i*)(in + 16));
+        __m128i in2 = _mm_loadu_si128((const __m128i*)(in + 32));
+
+        __m128i* out = (__m128i*)(rgba + i * 4);
+        _mm_storeu_si128(out, _mm_or_si128(_mm_shuffle_epi8(in0, spread), alpha));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(in1, in0, 12), spread), alpha));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(in2, in1, 8), spread), alpha));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(in2, 4), spread), alpha));
+    }
+    expandRgbScalar(rgb + i * 3, rgba + i * 4, pixelCount - i);
+}
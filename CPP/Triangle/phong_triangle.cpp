@@ -7,23 +7,40 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include "core/demo_app.h"
+#include "core/gl_objects.h"
+#include "core/frame_constants.h"
+#include "core/instance_buffer.h"
+
+// Radians per second of the triangle's spin
+const float kRotationSpeed = 0.6f;
 
 // Shader sources
 const char* vertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
+#ifdef INSTANCED
+layout (location = 2) in mat4 instanceModel;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;  // transpose(inverse(mat3(model))), computed on the CPU
 
 void main() {
-    FragPos = vec3(model * vec4(position, 1.0));
-    Normal = mat3(transpose(inverse(model))) * normal;
+#ifdef INSTANCED
+    // Instances only rotate, translate and scale uniformly, so mat3(instanceModel)
+    // transforms normals correctly up to length (renormalized per fragment)
+    mat4 world = model * instanceModel;
+    Normal = normalMatrix * mat3(instanceModel) * normal;
+#else
+    mat4 world = model;
+    Normal = normalMatrix * normal;
+#endif
+    FragPos = vec3(world * vec4(position, 1.0));
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
@@ -36,40 +53,40 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
 uniform vec3 objectColor;
 
 void main() {
     // Ambient
     float ambientStrength = 0.1;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = ambientStrength * lightColor.rgb;
     
     // Diffuse
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * lightColor.rgb;
     
     // Specular
     float specularStrength = 0.5;
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * spec * lightColor;
+    vec3 specular = specularStrength * spec * lightColor.rgb;
     
     vec3 result = (ambient + diffuse + specular) * objectColor;
     FragColor = vec4(result, 1.0);
 }
 )";
 
-class PhongTriangleRenderer {
+class PhongTriangleRenderer : public DemoApp {
 private:
-    GLFWwindow* window;
-    GLuint VAO, VBO;
-    GLuint shaderProgram;
-    int width, height;
+    Mesh mesh;
+    ShaderProgram shader;
+    FrameConstantsBuffer frameConstants;
+    InstanceBuffer instances;
+    
+    // Uniform handles, resolved once after linking
+    UniformHandle modelUniform, normalMatrixUniform, objectColorUniform;
     
     // Lighting parameters
     glm::vec3 lightPos;
@@ -82,10 +99,18 @@ private:
     glm::mat4 view;
     glm::mat4 projection;
     
-    float rotationAngle;
+    // Animation state after the last two simulation steps
+    float rotationAngle, previousRotationAngle;
+    
+    static DemoConfig makeConfig() {
+        DemoConfig config;
+        config.name = "phong_triangle";
+        config.title = "Phong Triangle Demo";
+        return config;
+    }
 
 public:
-    PhongTriangleRenderer() : width(800), height(600), rotationAngle(0.0f) {
+    PhongTriangleRenderer(const RunOptions& options) : DemoApp(makeConfig(), options), rotationAngle(0.0f), previousRotationAngle(0.0f) {
         // Initialize lighting
         lightPos = glm::vec3(2.0f, 2.0f, 2.0f);
         lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -95,57 +120,30 @@ public:
         // Initialize matrices
         model = glm::mat4(1.0f);
         view = glm::lookAt(viewPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-    }
-    
-    ~PhongTriangleRenderer() {
-        cleanup();
+        projection = glm::perspective(glm::radians(45.0f), (float)getWidth() / (float)getHeight(), 0.1f, 100.0f);
     }
     
-    bool init() {
-        // Initialize GLFW
-        if (!glfwInit()) {
-            std::cerr << "Failed to initialize GLFW" << std::endl;
+    bool setup() override {
+        if (!createShaders()) {
             return false;
         }
         
-        // Configure GLFW
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        
-        // Create window
-        window = glfwCreateWindow(width, height, "Phong Triangle Demo", nullptr, nullptr);
-        if (!window) {
-            std::cerr << "Failed to create GLFW window" << std::endl;
-            glfwTerminate();
+        if (!setupBuffers()) {
             return false;
         }
         
-        glfwMakeContextCurrent(window);
-        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-        
-        // Load OpenGL function pointers
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-            std::cerr << "Failed to initialize GLAD" << std::endl;
+        // Per-frame camera and lighting, shared by all programs
+        if (!frameConstants.create()) {
             return false;
         }
         
-        // Create shaders
-        if (!createShaders()) {
-            return false;
-        }
-        
-        // Setup buffers
-        setupBuffers();
-        
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
         
         return true;
     }
     
-    void setupBuffers() {
+    bool setupBuffers() {
         // Triangle vertices with positions and normals
         float vertices[] = {
             // positions          // normals
@@ -153,162 +151,105 @@ public:
             -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,  // bottom left
              0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f   // bottom right
         };
+        if (!mesh.create(vertices, 3, { 3, 3 })) {
+            return false;
+        }
         
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        
-        glBindVertexArray(VAO);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-        
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        
-        // Normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        
-        glBindVertexArray(0);
+        // Stress mode: many small independently transformed copies of the triangle
+        if (options.instances > 0) {
+            instances.create(mesh.getVertexArray(), 2, makeInstanceGrid(options.instances, 1.0f));
+            std::cout << "Instanced mode: " << options.instances << " triangles per frame" << std::endl;
+        }
+        return true;
     }
     
     bool createShaders() {
-        // Vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-        
-        // Check vertex shader compilation
-        GLint success;
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-            std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
-            return false;
+        // view, projection and lighting come from the shared FrameConstants block
+        std::string prelude = kFrameConstantsGlsl;
+        if (options.instances > 0) {
+            prelude += "#define INSTANCED\n";
         }
-        
-        // Fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
-        
-        // Check fragment shader compilation
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-            std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
+        if (!createProgram(shader, vertexShaderSource, fragmentShaderSource, prelude)) {
             return false;
         }
+        shader.bindUniformBlock("FrameConstants", kFrameConstantsBinding);
         
-        // Shader program
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        // Check program linking
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "Shader program linking failed: " << infoLog << std::endl;
-            return false;
-        }
-        
-        // Clean up shaders
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        // Look up uniforms once; render() only uses the handles
+        modelUniform = shader.getUniform("model");
+        normalMatrixUniform = shader.getUniform("normalMatrix");
+        objectColorUniform = shader.getUniform("objectColor");
         
         return true;
     }
     
-    void render() {
+    void update(float dt) override {
+        previousRotationAngle = rotationAngle;
+        rotationAngle += kRotationSpeed * dt;
+    }
+    
+    void render() override {
+        // Upload camera and lighting once for the whole frame
+        FrameConstants constants;
+        constants.view = view;
+        constants.projection = projection;
+        constants.lightPos = glm::vec4(lightPos, 1.0f);
+        constants.lightColor = glm::vec4(lightColor, 1.0f);
+        constants.viewPos = glm::vec4(viewPos, 1.0f);
+        frameConstants.update(constants);
+        
         // Clear screen
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            GpuZone zone(gpuProfiler, "clear");
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
         
         // Use shader program
-        glUseProgram(shaderProgram);
+        shader.use();
         
-        // Update rotation
-        rotationAngle += 0.01f;
-        model = glm::rotate(glm::mat4(1.0f), rotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        // Rotation between the last two simulation steps
+        float angle = glm::mix(previousRotationAngle, rotationAngle, (float)clock.getAlpha());
+        model = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f));
         
-        // Set uniforms
-        GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-        GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-        GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-        GLint lightPosLoc = glGetUniformLocation(shaderProgram, "lightPos");
-        GLint lightColorLoc = glGetUniformLocation(shaderProgram, "lightColor");
-        GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
-        GLint viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
+        // Once per object here instead of a 4x4 inverse for every vertex in the shader
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
         
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projection[0][0]);
-        glUniform3fv(lightPosLoc, 1, &lightPos[0]);
-        glUniform3fv(lightColorLoc, 1, &lightColor[0]);
-        glUniform3fv(objectColorLoc, 1, &objectColor[0]);
-        glUniform3fv(viewPosLoc, 1, &viewPos[0]);
+        // Set uniforms (unchanged values are not re-uploaded)
+        shader.set(modelUniform, model);
+        shader.set(normalMatrixUniform, normalMatrix);
+        shader.set(objectColorUniform, objectColor);
         
         // Draw triangle
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glBindVertexArray(0);
-    }
-    
-    void run() {
-        while (!glfwWindowShouldClose(window)) {
-            // Handle input
-            processInput();
-            
-            // Render
-            render();
-            
-            // Swap buffers and poll events
-            glfwSwapBuffers(window);
-            glfwPollEvents();
-        }
+        GpuZone zone(gpuProfiler, "draw");
+        mesh.draw(instances.getCount());
     }
     
-    void processInput() {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-            glfwSetWindowShouldClose(window, true);
-        }
+    void processInput() override {
+        DemoApp::processInput();
         
         // Change colors with keys
-        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_R)) {
             objectColor = glm::vec3(0.9f, 0.3f, 0.3f); // Red
         }
-        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_G)) {
             objectColor = glm::vec3(0.3f, 0.9f, 0.3f); // Green
         }
-        if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_B)) {
             objectColor = glm::vec3(0.3f, 0.3f, 0.9f); // Blue
         }
-        if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_Y)) {
             objectColor = glm::vec3(0.9f, 0.9f, 0.3f); // Yellow
         }
     }
-    
-    void cleanup() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteProgram(shaderProgram);
-        glfwTerminate();
-    }
-    
-    static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
-        glViewport(0, 0, width, height);
-    }
 };
 
-int main() {
-    PhongTriangleRenderer renderer;
+int main(int argc, char** argv) {
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) {
+        return -1;
+    }
     
+    PhongTriangleRenderer renderer(options);
     if (!renderer.init()) {
         std::cerr << "Failed to initialize renderer" << std::endl;
         return -1;
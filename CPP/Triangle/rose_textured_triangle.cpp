@@ -7,25 +7,35 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <fstream>
+#include "core/demo_app.h"
+#include "core/gl_objects.h"
+#include "core/frame_constants.h"
+#include "core/instance_buffer.h"
+#include "core/texture_manager.h"
 
-// For image loading - we'll use a simple approach
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+// Radians per second of the triangle's spin
+const float kRotationSpeed = 0.6f;
 
 // Shader sources
 const char* vertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texCoord;
+#ifdef INSTANCED
+layout (location = 2) in mat4 instanceModel;
+#endif
 
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
+#ifdef INSTANCED
+    gl_Position = projection * view * model * instanceModel * vec4(position, 1.0);
+#else
     gl_Position = projection * view * model * vec4(position, 1.0);
+#endif
     TexCoord = texCoord;
 }
 )";
@@ -45,13 +55,17 @@ void main() {
 }
 )";
 
-class RoseTexturedTriangleRenderer {
+class RoseTexturedTriangleRenderer : public DemoApp {
 private:
-    GLFWwindow* window;
-    GLuint VAO, VBO;
-    GLuint shaderProgram;
-    GLuint texture;
-    int width, height;
+    Mesh mesh;
+    ShaderProgram shader;
+    FrameConstantsBuffer frameConstants;
+    InstanceBuffer instances;
+    
+    // Uniform handles, resolved once after linking
+    UniformHandle modelUniform, objectColorUniform, textureUniform;
+    // Shared through the process-wide texture cache
+    TextureHandle texture;
     
     // Color parameters
     glm::vec3 objectColor;
@@ -61,60 +75,43 @@ private:
     glm::mat4 view;
     glm::mat4 projection;
     
-    float rotationAngle;
+    // Animation state after the last two simulation steps
+    float rotationAngle, previousRotationAngle;
+    
+    static DemoConfig makeConfig() {
+        DemoConfig config;
+        config.name = "rose_textured_triangle";
+        config.title = "Rose Textured Triangle Demo";
+        return config;
+    }
 
 public:
-    RoseTexturedTriangleRenderer() : width(800), height(600), rotationAngle(0.0f) {
+    RoseTexturedTriangleRenderer(const RunOptions& options) : DemoApp(makeConfig(), options), rotationAngle(0.0f), previousRotationAngle(0.0f) {
         // Initialize color
         objectColor = glm::vec3(1.0f, 1.0f, 1.0f); // White (no color tint)
         
         // Initialize matrices
         model = glm::mat4(1.0f);
         view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+        projection = glm::perspective(glm::radians(45.0f), (float)getWidth() / (float)getHeight(), 0.1f, 100.0f);
     }
     
-    ~RoseTexturedTriangleRenderer() {
-        cleanup();
-    }
-    
-    bool init() {
-        // Initialize GLFW
-        if (!glfwInit()) {
-            std::cerr << "Failed to initialize GLFW" << std::endl;
-            return false;
-        }
-        
-        // Configure GLFW
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        
-        // Create window
-        window = glfwCreateWindow(width, height, "Rose Textured Triangle Demo", nullptr, nullptr);
-        if (!window) {
-            std::cerr << "Failed to create GLFW window" << std::endl;
-            glfwTerminate();
+    bool setup() override {
+        // Create shaders
+        if (!createShaders()) {
             return false;
         }
         
-        glfwMakeContextCurrent(window);
-        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-        
-        // Load OpenGL function pointers
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-            std::cerr << "Failed to initialize GLAD" << std::endl;
+        // Setup buffers
+        if (!setupBuffers()) {
             return false;
         }
         
-        // Create shaders
-        if (!createShaders()) {
+        // Per-frame camera (view, projection), shared by all programs
+        if (!frameConstants.create()) {
             return false;
         }
         
-        // Setup buffers
-        setupBuffers();
-        
         // Load texture
         if (!loadTexture()) {
             return false;
@@ -126,7 +123,7 @@ public:
         return true;
     }
     
-    void setupBuffers() {
+    bool setupBuffers() {
         // Triangle vertices with positions and texture coordinates
         float vertices[] = {
             // positions          // texture coords
@@ -135,201 +132,149 @@ public:
              0.5f, -0.5f, 0.0f,   1.0f, 0.0f   // bottom right
         };
         
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        
-        glBindVertexArray(VAO);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-        
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        
-        // Texture coordinate attribute
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+        if (!mesh.create(vertices, 3, { 3, 2 })) {
+            return false;
+        }
         
-        glBindVertexArray(0);
+        // Stress mode: many small independently transformed copies of the triangle
+        if (options.instances > 0) {
+            instances.create(mesh.getVertexArray(), 2, makeInstanceGrid(options.instances, 1.0f));
+            std::cout << "Instanced mode: " << options.instances << " triangles per frame" << std::endl;
+        }
+        return true;
     }
     
     bool loadTexture() {
-        // Flip image vertically to match OpenGL coordinate system
-        stbi_set_flip_vertically_on_load(true);
-        
-        // Load rose.png image
-        int imgWidth, imgHeight, nrChannels;
-        unsigned char *data = stbi_load("rose.png", &imgWidth, &imgHeight, &nrChannels, 0);
-        
-        if (!data) {
-            std::cerr << "Failed to load rose.png texture" << std::endl;
-            std::cerr << "Make sure rose.png is in the same directory as the executable" << std::endl;
-            return false;
+        // --texture pins one file, so a run does not depend on what the driver can sample
+        if (!options.texture.empty()) {
+            texture = getTextureManager().acquire(options.texture);
+            if (!texture) {
+                return false;
+            }
         }
         
-        std::cout << "Loaded rose.png: " << imgWidth << "x" << imgHeight << " channels: " << nrChannels << std::endl;
-        
-        // Generate texture
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Otherwise prefer the files texture_baker makes at build time: no
+        // decode, every mip level is uploaded straight from the mapped file.
+        // BC7 takes a quarter of the memory of RGBA8, where the driver can
+        // sample it. Every renderer in the process shares the one texture.
+        for (const char* path : { "rose_bc7.ktx2", "rose.ktx2" }) {
+            if (!texture && std::ifstream(path).good()) {
+                texture = getTextureManager().acquire(path);
+            }
+        }
         
-        // Upload texture data
-        GLenum format = GL_RGB;
-        if (nrChannels == 4) {
-            format = GL_RGBA;
+        // Otherwise rose.png is decoded and uploaded in the background; until
+        // then (or for good, if it does not decode) the texture holds a grey
+        // placeholder texel
+        if (!texture) {
+            texture = getTextureManager().acquire("rose.png");
+            if (!texture) {
+                return false;
+            }
         }
         
-        glTexImage2D(GL_TEXTURE_2D, 0, format, imgWidth, imgHeight, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        // The manager sets repeat wrapping and trilinear filtering on the shared
+        // texture; both paths upload a full mip chain filtered on the CPU
         
-        // Free image data
-        stbi_image_free(data);
+        // Measured and replayed frames should all draw the real texture
+        if (options.benchmark || options.clock == ClockMode::Replay) {
+            getTextureManager().finish();
+            if (texture->hasFailed()) {
+                return false;
+            }
+        }
         
         return true;
     }
     
     bool createShaders() {
-        // Vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-        
-        // Check vertex shader compilation
-        GLint success;
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-            std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
-            return false;
-        }
-        
-        // Fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
-        
-        // Check fragment shader compilation
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-            std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
-            return false;
+        // The camera (view, projection) comes from the shared FrameConstants block
+        std::string prelude = kFrameConstantsGlsl;
+        if (options.instances > 0) {
+            prelude += "#define INSTANCED\n";
         }
-        
-        // Shader program
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        // Check program linking
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "Shader program linking failed: " << infoLog << std::endl;
+        if (!createProgram(shader, vertexShaderSource, fragmentShaderSource, prelude)) {
             return false;
         }
+        shader.bindUniformBlock("FrameConstants", kFrameConstantsBinding);
         
-        // Clean up shaders
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        // Look up uniforms once; render() only uses the handles
+        modelUniform = shader.getUniform("model");
+        objectColorUniform = shader.getUniform("objectColor");
+        textureUniform = shader.getUniform("texture1");
         
         return true;
     }
     
-    void render() {
+    void update(float dt) override {
+        previousRotationAngle = rotationAngle;
+        rotationAngle += kRotationSpeed * dt;
+    }
+    
+    void render() override {
+        // Move finished texture decodes towards the GPU
+        getTextureManager().update();
+        
+        // Upload the camera once for the whole frame
+        FrameConstants constants;
+        constants.view = view;
+        constants.projection = projection;
+        frameConstants.update(constants);
+        
         // Clear screen
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            GpuZone zone(gpuProfiler, "clear");
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
         
         // Use shader program
-        glUseProgram(shaderProgram);
-        
-        // Update rotation
-        rotationAngle += 0.01f;
-        model = glm::rotate(glm::mat4(1.0f), rotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        shader.use();
         
-        // Set uniforms
-        GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-        GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-        GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-        GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
+        // Rotation between the last two simulation steps
+        float angle = glm::mix(previousRotationAngle, rotationAngle, (float)clock.getAlpha());
+        model = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f));
         
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projection[0][0]);
-        glUniform3fv(objectColorLoc, 1, &objectColor[0]);
+        // Set uniforms (unchanged values are not re-uploaded)
+        shader.set(modelUniform, model);
+        shader.set(objectColorUniform, objectColor);
+        shader.set(textureUniform, 0);
         
         // Bind texture
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindTexture(GL_TEXTURE_2D, texture->get());
         
         // Draw triangle
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glBindVertexArray(0);
-    }
-    
-    void run() {
-        while (!glfwWindowShouldClose(window)) {
-            // Handle input
-            processInput();
-            
-            // Render
-            render();
-            
-            // Swap buffers and poll events
-            glfwSwapBuffers(window);
-            glfwPollEvents();
-        }
+        GpuZone zone(gpuProfiler, "draw");
+        mesh.draw(instances.getCount());
     }
     
-    void processInput() {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-            glfwSetWindowShouldClose(window, true);
-        }
+    void processInput() override {
+        DemoApp::processInput();
         
         // Change colors with keys
-        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_R)) {
             objectColor = glm::vec3(1.0f, 0.3f, 0.3f); // Red tint
         }
-        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_G)) {
             objectColor = glm::vec3(0.3f, 1.0f, 0.3f); // Green tint
         }
-        if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_B)) {
             objectColor = glm::vec3(0.3f, 0.3f, 1.0f); // Blue tint
         }
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+        if (context.isKeyPressed(GLFW_KEY_W)) {
             objectColor = glm::vec3(1.0f, 1.0f, 1.0f); // White (no tint)
         }
     }
-    
-    void cleanup() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteProgram(shaderProgram);
-        glDeleteTextures(1, &texture);
-        glfwTerminate();
-    }
-    
-    static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
-        glViewport(0, 0, width, height);
-    }
 };
 
-int main() {
-    RoseTexturedTriangleRenderer renderer;
+int main(int argc, char** argv) {
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) {
+        return -1;
+    }
     
+    RoseTexturedTriangleRenderer renderer(options);
     if (!renderer.init()) {
         std::cerr << "Failed to initialize renderer" << std::endl;
         return -1;
@@ -0,0 +1,213 @@
+// CPU reference renderer for the triangle demos. Runs the scenes of
+// triangle_demo.cpp ("demo", interpolated vertex colors), simple_triangle.cpp
+// ("simple", flat purple) and phong_triangle.cpp ("phong", rotating lit
+// triangle, SIMD shaded) on the tile-binned software rasterizer and reports
+// throughput in pixels per second.
+//
+//   soft_triangle [--scene demo|simple|phong] [--size WxH] [--threads N]
+//                 [--frames N] [--output image.ppm]
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include "softraster/rasterizer.h"
+
+struct Scene {
+    std::vector<RasterVertex> vertices;
+    glm::vec4 clearColor;
+    DrawState state;
+    // Per-frame vertex stage for animated scenes
+    void (*update)(Scene& scene, int width, int height, int frame) = nullptr;
+};
+
+static RasterVertex makeVertex(float x, float y, float z, float r, float g, float b) {
+    RasterVertex vertex = {};
+    // The demo vertex shaders pass positions straight through: gl_Position = vec4(position, 1.0)
+    vertex.position = glm::vec4(x, y, z, 1.0f);
+    vertex.varyings[0] = r;
+    vertex.varyings[1] = g;
+    vertex.varyings[2] = b;
+    return vertex;
+}
+
+// phong_triangle.cpp's vertex shader on the CPU: FragPos and Normal become
+// varyings 0-5. The demo turns at kRotationSpeed (0.6 rad/s) in fixed 1/60 s
+// clock steps, 0.01 rad per step; with --clock replay that is one step per
+// frame, which is what this matches.
+static void updatePhongScene(Scene& scene, int width, int height, int frame) {
+    static const glm::vec3 positions[3] = {
+        glm::vec3( 0.0f,  0.5f, 0.0f),  // top
+        glm::vec3(-0.5f, -0.5f, 0.0f),  // bottom left
+        glm::vec3( 0.5f, -0.5f, 0.0f)   // bottom right
+    };
+    const glm::vec3 normal(0.0f, 0.0f, 1.0f);
+
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), 0.01f * frame, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    glm::mat4 view = glm::lookAt(scene.state.phong.viewPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+
+    scene.vertices.resize(3);
+    for (int i = 0; i < 3; i++) {
+        glm::vec3 fragPos = glm::vec3(model * glm::vec4(positions[i], 1.0f));
+        glm::vec3 worldNormal = normalMatrix * normal;
+        RasterVertex& vertex = scene.vertices[i];
+        vertex.position = projection * view * glm::vec4(fragPos, 1.0f);
+        vertex.varyings[0] = fragPos.x;
+        vertex.varyings[1] = fragPos.y;
+        vertex.varyings[2] = fragPos.z;
+        vertex.varyings[3] = worldNormal.x;
+        vertex.varyings[4] = worldNormal.y;
+        vertex.varyings[5] = worldNormal.z;
+    }
+}
+
+static bool createScene(const std::string& name, Scene& scene) {
+    scene.clearColor = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+    if (name == "demo") {
+        scene.vertices = {
+            makeVertex(-0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f),  // Red
+            makeVertex( 0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f),  // Green
+            makeVertex( 0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f)   // Blue
+        };
+        return true;
+    }
+    if (name == "simple") {
+        // Constant fragment color, i.e. the same color at every vertex
+        scene.vertices = {
+            makeVertex(-0.5f, -0.5f, 0.0f, 0.8f, 0.3f, 0.8f),  // Left
+            makeVertex( 0.5f, -0.5f, 0.0f, 0.8f, 0.3f, 0.8f),  // Right
+            makeVertex( 0.0f,  0.5f, 0.0f, 0.8f, 0.3f, 0.8f)   // Top
+        };
+        return true;
+    }
+    if (name == "phong") {
+        scene.clearColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+        scene.state.shading = ShadeMode::Phong;
+        scene.state.varyingCount = 6;
+        scene.state.depthTest = true;
+        scene.update = updatePhongScene;
+        return true;
+    }
+    std::cerr << "Unknown scene '" << name << "' (expected demo, simple or phong)" << std::endl;
+    return false;
+}
+
+// Binary PPM, flipped so the bottom row of the framebuffer ends up at the bottom of the image
+static bool writePpm(const std::string& path, const Framebuffer& framebuffer) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file << "P6\n" << framebuffer.width << " " << framebuffer.height << "\n255\n";
+    std::vector<unsigned char> row(framebuffer.width * 3);
+    for (int y = framebuffer.height - 1; y >= 0; y--) {
+        const uint32_t* pixels = &framebuffer.color[(size_t)y * framebuffer.width];
+        for (int x = 0; x < framebuffer.width; x++) {
+            row[x * 3 + 0] = (unsigned char)(pixels[x] & 0xff);
+            row[x * 3 + 1] = (unsigned char)((pixels[x] >> 8) & 0xff);
+            row[x * 3 + 2] = (unsigned char)((pixels[x] >> 16) & 0xff);
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+    return (bool)file;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--scene demo|simple|phong] [--size WxH] [--threads N]"
+              << " [--frames N] [--output image.ppm]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string sceneName = "demo";
+    std::string outputPath;
+    int width = 800;
+    int height = 600;
+    int threads = 0;
+    int frames = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--scene" && i + 1 < argc) {
+            sceneName = argv[++i];
+        } else if (arg == "--size" && i + 1 < argc) {
+            std::string size = argv[++i];
+            size_t separator = size.find('x');
+            if (separator == std::string::npos) {
+                printUsage(argv[0]);
+                return -1;
+            }
+            width = std::atoi(size.substr(0, separator).c_str());
+            height = std::atoi(size.substr(separator + 1).c_str());
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+    // 16384 keeps guard-band coordinates well inside the fixed-point range
+    if (width < 1 || height < 1 || width > 16384 || height > 16384 || frames < 1 || threads < 0) {
+        std::cerr << "--size must be between 1x1 and 16384x16384, --frames positive and --threads non-negative" << std::endl;
+        return -1;
+    }
+
+    Scene scene;
+    if (!createScene(sceneName, scene)) {
+        return -1;
+    }
+
+    Rasterizer rasterizer(width, height, threads);
+
+    // Frame 0 is untimed and warms up the caches and the worker threads
+    std::vector<double> frameMs;
+    uint64_t fragments = 0;
+    for (int frame = 0; frame <= frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        if (scene.update) {
+            scene.update(scene, width, height, frame);
+        }
+        rasterizer.beginFrame(scene.clearColor);
+        rasterizer.draw(scene.state, scene.vertices.data(), scene.vertices.size());
+        uint64_t frameFragments = rasterizer.endFrame();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (frame > 0) {
+            frameMs.push_back(elapsed.count());
+            fragments += frameFragments;
+        }
+    }
+
+    double totalSeconds = 0.0;
+    for (double ms : frameMs) {
+        totalSeconds += ms / 1000.0;
+    }
+    std::sort(frameMs.begin(), frameMs.end());
+
+    // "Pixels" counts every framebuffer pixel produced (clear included); "fragments" only the shaded ones
+    double pixels = (double)width * height * frames;
+    std::cout << "soft_triangle: scene " << sceneName << ", " << width << "x" << height << ", "
+              << rasterizer.getThreadCount() << " threads, " << simdLevelName(rasterizer.getSimdLevel()) << " kernels" << std::endl;
+    std::cout << "  " << frames << " frames in " << totalSeconds << " s, median "
+              << frameMs[frameMs.size() / 2] << " ms/frame" << std::endl;
+    std::cout << "  " << pixels / totalSeconds / 1e6 << " Mpixels/s, "
+              << fragments / totalSeconds / 1e6 << " Mfragments/s ("
+              << fragments / frames << " fragments/frame)" << std::endl;
+
+    if (!outputPath.empty()) {
+        if (!writePpm(outputPath, rasterizer.getFramebuffer())) {
+            return -1;
+        }
+        std::cout << "Image written to " << outputPath << std::endl;
+    }
+    return 0;
+}
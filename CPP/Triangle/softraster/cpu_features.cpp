@@ -0,0 +1,72 @@
+#include "cpu_features.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(SOFTRASTER_X86_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+static SimdLevel detectHardwareLevel() {
+#if defined(SOFTRASTER_X86_KERNELS)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    // AVX state must also be enabled by the OS (OSXSAVE + XCR0 bits 1 and 2)
+    bool avxEnabled = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = avxEnabled && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    bool fma = __builtin_cpu_supports("fma");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2 && fma) {
+        return SimdLevel::AVX2;
+    }
+    if (sse41) {
+        return SimdLevel::SSE41;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = [] {
+        SimdLevel detected = detectHardwareLevel();
+        const char* requested = std::getenv("SOFTRASTER_SIMD");
+        if (!requested) {
+            return detected;
+        }
+
+        SimdLevel cap;
+        if (std::strcmp(requested, "scalar") == 0) {
+            cap = SimdLevel::Scalar;
+        } else if (std::strcmp(requested, "sse4.1") == 0) {
+            cap = SimdLevel::SSE41;
+        } else if (std::strcmp(requested, "avx2") == 0) {
+            cap = SimdLevel::AVX2;
+        } else {
+            std::cerr << "Ignoring unknown SOFTRASTER_SIMD value '" << requested << "'" << std::endl;
+            return detected;
+        }
+        return cap < detected ? cap : detected;
+    }();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
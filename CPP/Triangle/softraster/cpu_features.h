@@ -0,0 +1,15 @@
+#pragma once
+
+// Instruction sets the CPU kernels are compiled for, in increasing order
+enum class SimdLevel {
+    Scalar,
+    SSE41,
+    AVX2  // AVX2 + FMA
+};
+
+// Best level supported by both this build and the CPU. Setting the
+// SOFTRASTER_SIMD environment variable to scalar, sse4.1 or avx2 caps it,
+// which is how the kernels are compared on one machine.
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
@@ -0,0 +1,46 @@
+#include "phong_kernel.h"
+#include "pixel_format.h"
+
+#include <algorithm>
+
+// Constants from the GLSL shader
+static const float kAmbientStrength = 0.1f;
+static const float kSpecularStrength = 0.5f;
+
+PhongKernel getPhongKernel(SimdLevel level) {
+#ifdef SOFTRASTER_X86_KERNELS
+    if (level >= SimdLevel::AVX2) {
+        return shadePhongAvx2;
+    }
+    if (level >= SimdLevel::SSE41) {
+        return shadePhongSse41;
+    }
+#else
+    (void)level;
+#endif
+    return shadePhongScalar;
+}
+
+void shadePhongScalar(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors) {
+    // Every term of the shader is a multiple of lightColor * objectColor
+    glm::vec3 base = uniforms.lightColor * uniforms.objectColor;
+
+    for (int i = 0; i < kPhongBatchSize; i++) {
+        glm::vec3 fragPos(batch.positionX[i], batch.positionY[i], batch.positionZ[i]);
+        glm::vec3 norm = glm::normalize(glm::vec3(batch.normalX[i], batch.normalY[i], batch.normalZ[i]));
+
+        glm::vec3 lightDir = glm::normalize(uniforms.lightPos - fragPos);
+        float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+
+        glm::vec3 viewDir = glm::normalize(uniforms.viewPos - fragPos);
+        glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+        float spec = std::max(glm::dot(viewDir, reflectDir), 0.0f);
+        // pow(spec, 32) as five squarings, exactly like the SIMD kernels
+        for (int k = 0; k < 5; k++) {
+            spec *= spec;
+        }
+
+        glm::vec3 result = base * (kAmbientStrength + diff + kSpecularStrength * spec);
+        colors[i] = packRgba8(result.x, result.y, result.z, 1.0f);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "cpu_features.h"
+
+// Inputs of the phong_triangle.cpp fragment shader that are constant per draw
+struct PhongUniforms {
+    glm::vec3 lightPos = glm::vec3(2.0f, 2.0f, 2.0f);
+    glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::vec3 objectColor = glm::vec3(0.3f, 0.7f, 0.9f);
+    glm::vec3 viewPos = glm::vec3(0.0f, 0.0f, 3.0f);
+};
+
+// Eight fragments in structure-of-arrays form, one SIMD lane per fragment
+constexpr int kPhongBatchSize = 8;
+
+struct alignas(32) PhongBatch {
+    float positionX[kPhongBatchSize];  // FragPos (world space)
+    float positionY[kPhongBatchSize];
+    float positionZ[kPhongBatchSize];
+    float normalX[kPhongBatchSize];    // Normal, not yet normalized
+    float normalY[kPhongBatchSize];
+    float normalZ[kPhongBatchSize];
+};
+
+// Shades all eight lanes (ambient + diffuse + specular with shininess 32) and
+// writes the results as packed RGBA8 with alpha 255. Unused lanes just need
+// to hold finite values.
+using PhongKernel = void (*)(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors);
+
+// Kernel for the given level, or for the best level below it that this build has
+PhongKernel getPhongKernel(SimdLevel level);
+
+void shadePhongScalar(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors);
+#ifdef SOFTRASTER_X86_KERNELS
+// Defined in translation units built with -msse4.1 and -mavx2 -mfma; only
+// call them after checking detectSimdLevel()
+void shadePhongSse41(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors);
+void shadePhongAvx2(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors);
+#endif
@@ -0,0 +1,76 @@
+// Built with -mavx2 -mfma; only reached through getPhongKernel()
+#include "phong_kernel.h"
+
+#include <immintrin.h>
+
+namespace {
+
+// 1/sqrt(x): hardware estimate (12 bits) refined with one Newton-Raphson step
+inline __m256 reciprocalSqrt(__m256 x) {
+    __m256 y = _mm256_rsqrt_ps(x);
+    __m256 halfX = _mm256_mul_ps(_mm256_set1_ps(0.5f), x);
+    return _mm256_mul_ps(y, _mm256_fnmadd_ps(halfX, _mm256_mul_ps(y, y), _mm256_set1_ps(1.5f)));
+}
+
+inline void normalize(__m256& x, __m256& y, __m256& z) {
+    __m256 length2 = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+    __m256 scale = reciprocalSqrt(length2);
+    x = _mm256_mul_ps(x, scale);
+    y = _mm256_mul_ps(y, scale);
+    z = _mm256_mul_ps(z, scale);
+}
+
+inline __m256 dot(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz) {
+    return _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx)));
+}
+
+// Clamp to [0, 1] (NaN becomes 0), scale and round like toUnorm8()
+inline __m256i toUnorm8(__m256 value) {
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_fmadd_ps(value, _mm256_set1_ps(255.0f), _mm256_set1_ps(0.5f)));
+}
+
+}
+
+void shadePhongAvx2(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors) {
+    const __m256 zero = _mm256_setzero_ps();
+    glm::vec3 base = uniforms.lightColor * uniforms.objectColor;
+
+    __m256 px = _mm256_load_ps(batch.positionX);
+    __m256 py = _mm256_load_ps(batch.positionY);
+    __m256 pz = _mm256_load_ps(batch.positionZ);
+    __m256 nx = _mm256_load_ps(batch.normalX);
+    __m256 ny = _mm256_load_ps(batch.normalY);
+    __m256 nz = _mm256_load_ps(batch.normalZ);
+    normalize(nx, ny, nz);
+
+    // Diffuse
+    __m256 lx = _mm256_sub_ps(_mm256_set1_ps(uniforms.lightPos.x), px);
+    __m256 ly = _mm256_sub_ps(_mm256_set1_ps(uniforms.lightPos.y), py);
+    __m256 lz = _mm256_sub_ps(_mm256_set1_ps(uniforms.lightPos.z), pz);
+    normalize(lx, ly, lz);
+    __m256 normalDotLight = dot(nx, ny, nz, lx, ly, lz);
+    __m256 diff = _mm256_max_ps(normalDotLight, zero);
+
+    // Specular: reflect(-L, n) = 2 * dot(n, L) * n - L
+    __m256 vx = _mm256_sub_ps(_mm256_set1_ps(uniforms.viewPos.x), px);
+    __m256 vy = _mm256_sub_ps(_mm256_set1_ps(uniforms.viewPos.y), py);
+    __m256 vz = _mm256_sub_ps(_mm256_set1_ps(uniforms.viewPos.z), pz);
+    normalize(vx, vy, vz);
+    __m256 twoNdotL = _mm256_add_ps(normalDotLight, normalDotLight);
+    __m256 rx = _mm256_fmsub_ps(twoNdotL, nx, lx);
+    __m256 ry = _mm256_fmsub_ps(twoNdotL, ny, ly);
+    __m256 rz = _mm256_fmsub_ps(twoNdotL, nz, lz);
+    __m256 spec = _mm256_max_ps(dot(vx, vy, vz, rx, ry, rz), zero);
+    for (int k = 0; k < 5; k++) {
+        spec = _mm256_mul_ps(spec, spec);
+    }
+
+    __m256 intensity = _mm256_fmadd_ps(_mm256_set1_ps(0.5f), spec, _mm256_add_ps(_mm256_set1_ps(0.1f), diff));
+    __m256i r = toUnorm8(_mm256_mul_ps(_mm256_set1_ps(base.x), intensity));
+    __m256i g = toUnorm8(_mm256_mul_ps(_mm256_set1_ps(base.y), intensity));
+    __m256i b = toUnorm8(_mm256_mul_ps(_mm256_set1_ps(base.z), intensity));
+    __m256i packed = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                     _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32((int)0xff000000u)));
+    _mm256_storeu_si256((__m256i*)colors, packed);
+}
@@ -0,0 +1,81 @@
+// Built with -msse4.1; only reached through getPhongKernel()
+#include "phong_kernel.h"
+
+#include <smmintrin.h>
+
+namespace {
+
+// 1/sqrt(x): hardware estimate (12 bits) refined with one Newton-Raphson step
+inline __m128 reciprocalSqrt(__m128 x) {
+    __m128 y = _mm_rsqrt_ps(x);
+    __m128 halfXyy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(y, y));
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), halfXyy));
+}
+
+inline void normalize(__m128& x, __m128& y, __m128& z) {
+    __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    __m128 scale = reciprocalSqrt(length2);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+}
+
+inline __m128 dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+// Clamp to [0, 1] (NaN becomes 0), scale and round like toUnorm8()
+inline __m128i toUnorm8(__m128 value) {
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+}
+
+void shadePhongSse41(const PhongUniforms& uniforms, const PhongBatch& batch, uint32_t* colors) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 ambient = _mm_set1_ps(0.1f);
+    const __m128 specularStrength = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000u);
+    glm::vec3 base = uniforms.lightColor * uniforms.objectColor;
+
+    for (int offset = 0; offset < kPhongBatchSize; offset += 4) {
+        __m128 px = _mm_load_ps(batch.positionX + offset);
+        __m128 py = _mm_load_ps(batch.positionY + offset);
+        __m128 pz = _mm_load_ps(batch.positionZ + offset);
+        __m128 nx = _mm_load_ps(batch.normalX + offset);
+        __m128 ny = _mm_load_ps(batch.normalY + offset);
+        __m128 nz = _mm_load_ps(batch.normalZ + offset);
+        normalize(nx, ny, nz);
+
+        // Diffuse
+        __m128 lx = _mm_sub_ps(_mm_set1_ps(uniforms.lightPos.x), px);
+        __m128 ly = _mm_sub_ps(_mm_set1_ps(uniforms.lightPos.y), py);
+        __m128 lz = _mm_sub_ps(_mm_set1_ps(uniforms.lightPos.z), pz);
+        normalize(lx, ly, lz);
+        __m128 normalDotLight = dot(nx, ny, nz, lx, ly, lz);
+        __m128 diff = _mm_max_ps(normalDotLight, zero);
+
+        // Specular: reflect(-L, n) = 2 * dot(n, L) * n - L
+        __m128 vx = _mm_sub_ps(_mm_set1_ps(uniforms.viewPos.x), px);
+        __m128 vy = _mm_sub_ps(_mm_set1_ps(uniforms.viewPos.y), py);
+        __m128 vz = _mm_sub_ps(_mm_set1_ps(uniforms.viewPos.z), pz);
+        normalize(vx, vy, vz);
+        __m128 twoNdotL = _mm_mul_ps(two, normalDotLight);
+        __m128 rx = _mm_sub_ps(_mm_mul_ps(twoNdotL, nx), lx);
+        __m128 ry = _mm_sub_ps(_mm_mul_ps(twoNdotL, ny), ly);
+        __m128 rz = _mm_sub_ps(_mm_mul_ps(twoNdotL, nz), lz);
+        __m128 spec = _mm_max_ps(dot(vx, vy, vz, rx, ry, rz), zero);
+        for (int k = 0; k < 5; k++) {
+            spec = _mm_mul_ps(spec, spec);
+        }
+
+        __m128 intensity = _mm_add_ps(_mm_add_ps(ambient, diff), _mm_mul_ps(specularStrength, spec));
+        __m128i r = toUnorm8(_mm_mul_ps(_mm_set1_ps(base.x), intensity));
+        __m128i g = toUnorm8(_mm_mul_ps(_mm_set1_ps(base.y), intensity));
+        __m128i b = toUnorm8(_mm_mul_ps(_mm_set1_ps(base.z), intensity));
+        __m128i packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), alpha));
+        _mm_storeu_si128((__m128i*)(colors + offset), packed);
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// Float to UNORM8 conversion as OpenGL does it: clamp, scale, round to nearest
+inline uint32_t toUnorm8(float value) {
+    return (uint32_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// R in the lowest byte, so the bytes in memory read R, G, B, A
+inline uint32_t packRgba8(float r, float g, float b, float a) {
+    return toUnorm8(r) | (toUnorm8(g) << 8) | (toUnorm8(b) << 16) | (toUnorm8(a) << 24);
+}
@@ -0,0 +1,408 @@
+#include "rasterizer.h"
+#include "pixel_format.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Triangles are clipped against the near and far planes and against a guard
+// band this many viewports wide, so window coordinates always fit the
+// fixed-point range; clipping at the real viewport edges is left to the
+// per-pixel edge tests.
+static const float kGuardBand = 8.0f;
+
+static const glm::vec4 clipPlanes[] = {
+    glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),         // near:  z >= -w
+    glm::vec4(0.0f, 0.0f, -1.0f, 1.0f),        // far:   z <= w
+    glm::vec4(1.0f, 0.0f, 0.0f, kGuardBand),   // x >= -guard * w
+    glm::vec4(-1.0f, 0.0f, 0.0f, kGuardBand),  // x <= guard * w
+    glm::vec4(0.0f, 1.0f, 0.0f, kGuardBand),   // y >= -guard * w
+    glm::vec4(0.0f, -1.0f, 0.0f, kGuardBand),  // y <= guard * w
+};
+static const int clipPlaneCount = sizeof(clipPlanes) / sizeof(clipPlanes[0]);
+
+// A triangle clipped by every plane has at most 3 + planes vertices
+static const int maxClippedVertices = 3 + clipPlaneCount;
+
+static RasterVertex lerpVertex(const RasterVertex& from, const RasterVertex& to, float t, int varyingCount) {
+    RasterVertex result;
+    result.position = from.position + (to.position - from.position) * t;
+    for (int i = 0; i < varyingCount; i++) {
+        result.varyings[i] = from.varyings[i] + (to.varyings[i] - from.varyings[i]) * t;
+    }
+    return result;
+}
+
+// Sutherland-Hodgman against one plane; returns the new vertex count
+static int clipPolygon(const RasterVertex* in, int count, RasterVertex* out, const glm::vec4& plane, int varyingCount) {
+    int outCount = 0;
+    for (int i = 0; i < count; i++) {
+        const RasterVertex& current = in[i];
+        const RasterVertex& next = in[(i + 1) % count];
+        float currentDistance = glm::dot(plane, current.position);
+        float nextDistance = glm::dot(plane, next.position);
+
+        if (currentDistance >= 0.0f) {
+            out[outCount++] = current;
+        }
+        if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+            float t = currentDistance / (currentDistance - nextDistance);
+            out[outCount++] = lerpVertex(current, next, t, varyingCount);
+        }
+    }
+    return outCount;
+}
+
+Rasterizer::Rasterizer(int width, int height, int threadCount)
+    : pool(threadCount), clearColor(0.0f), clearDepth(1.0f),
+      simdLevel(detectSimdLevel()), phongKernel(getPhongKernel(simdLevel)) {
+    framebuffer.width = width;
+    framebuffer.height = height;
+    framebuffer.color.assign((size_t)width * height, 0);
+    framebuffer.depth.assign((size_t)width * height, 1.0f);
+    tilesX = (width + kTileSize - 1) / kTileSize;
+    tilesY = (height + kTileSize - 1) / kTileSize;
+    workers.resize(pool.getWorkerCount());
+}
+
+void Rasterizer::beginFrame(const glm::vec4& color, float depth) {
+    clearColor = color;
+    clearDepth = depth;
+    vertices.clear();
+    draws.clear();
+}
+
+void Rasterizer::draw(const DrawState& state, const RasterVertex* first, size_t count) {
+    DrawCall call;
+    call.state = state;
+    call.state.varyingCount = std::min(std::max(state.varyingCount, 0), kMaxVaryings);
+    call.firstVertex = vertices.size();
+    call.vertexCount = count - count % 3;
+    vertices.insert(vertices.end(), first, first + call.vertexCount);
+    draws.push_back(call);
+}
+
+uint64_t Rasterizer::endFrame() {
+    int tileCount = tilesX * tilesY;
+    for (auto& data : workers) {
+        data.triangles.clear();
+        data.bins.resize(tileCount);
+        for (auto& bin : data.bins) {
+            bin.clear();
+        }
+        data.fragments = 0;
+    }
+
+    pool.run([this](int worker) { setupTriangles(worker); });
+
+    tileQueue.reset(tileCount, (int)workers.size());
+    pool.run([this](int worker) { rasterizeTiles(worker); });
+
+    uint64_t fragments = 0;
+    for (const auto& data : workers) {
+        fragments += data.fragments;
+    }
+    return fragments;
+}
+
+void Rasterizer::setupTriangles(int worker) {
+    size_t triangleCount = vertices.size() / 3;
+    size_t workerCount = workers.size();
+    size_t begin = triangleCount * worker / workerCount;
+    size_t end = triangleCount * (worker + 1) / workerCount;
+
+    // Contiguous slices keep submission order: worker 0 has the earliest triangles
+    WorkerData& data = workers[worker];
+    for (size_t d = 0; d < draws.size() && begin < end; d++) {
+        size_t drawBegin = draws[d].firstVertex / 3;
+        size_t drawEnd = drawBegin + draws[d].vertexCount / 3;
+        for (; begin < end && begin < drawEnd; begin++) {
+            if (begin >= drawBegin) {
+                setupTriangle(data, &vertices[begin * 3], (int)d);
+            }
+        }
+    }
+}
+
+void Rasterizer::setupTriangle(WorkerData& data, const RasterVertex* v, int draw) {
+    int varyingCount = draws[draw].state.varyingCount;
+
+    // Most triangles are entirely inside every plane and skip the clipper
+    bool inside = true;
+    for (int p = 0; p < clipPlaneCount && inside; p++) {
+        for (int i = 0; i < 3; i++) {
+            if (glm::dot(clipPlanes[p], v[i].position) < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+    }
+
+    RasterVertex polygon[2][maxClippedVertices];
+    int count = 3;
+    const RasterVertex* clipped = v;
+    if (!inside) {
+        std::copy(v, v + 3, polygon[0]);
+        int current = 0;
+        for (int p = 0; p < clipPlaneCount && count >= 3; p++) {
+            count = clipPolygon(polygon[current], count, polygon[1 - current], clipPlanes[p], varyingCount);
+            current = 1 - current;
+        }
+        if (count < 3) {
+            return;
+        }
+        clipped = polygon[current];
+    }
+
+    int width = framebuffer.width;
+    int height = framebuffer.height;
+    const float subpixelScale = (float)(1 << kSubpixelBits);
+
+    // Fan triangulation keeps the winding of the original triangle
+    for (int fan = 1; fan + 1 < count; fan++) {
+        const RasterVertex* corners[3] = { &clipped[0], &clipped[fan], &clipped[fan + 1] };
+
+        int64_t x[3], y[3];
+        float z[3], invW[3];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4& position = corners[i]->position;
+            invW[i] = 1.0f / position.w;
+            float windowX = (position.x * invW[i] * 0.5f + 0.5f) * width;
+            float windowY = (position.y * invW[i] * 0.5f + 0.5f) * height;
+            x[i] = (int64_t)std::llround(windowX * subpixelScale);
+            y[i] = (int64_t)std::llround(windowY * subpixelScale);
+            z[i] = position.z * invW[i] * 0.5f + 0.5f;
+        }
+
+        // Culling is off, as in the demos: flip clockwise triangles to counter-clockwise
+        int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0) {
+            continue;
+        }
+        int order[3] = { 0, 1, 2 };
+        if (area < 0) {
+            std::swap(order[1], order[2]);
+            area = -area;
+        }
+
+        SetupTriangle triangle;
+        triangle.draw = draw;
+        triangle.invArea = 1.0f / (float)area;
+
+        int64_t minX = INT64_MAX, minY = INT64_MAX, maxX = INT64_MIN, maxY = INT64_MIN;
+        for (int i = 0; i < 3; i++) {
+            int from = order[(i + 1) % 3];
+            int to = order[(i + 2) % 3];
+
+            // Edge opposite vertex i; positive on the inside, equal to area at vertex i
+            triangle.a[i] = y[from] - y[to];
+            triangle.b[i] = x[to] - x[from];
+            triangle.c[i] = -triangle.a[i] * x[from] - triangle.b[i] * y[from];
+
+            // Top-left rule: pixel centers exactly on an edge belong to the
+            // triangle only for left edges (going down) and top edges (going left)
+            int64_t dx = x[to] - x[from];
+            int64_t dy = y[to] - y[from];
+            bool topLeft = dy < 0 || (dy == 0 && dx < 0);
+            if (!topLeft) {
+                triangle.c[i] -= 1;
+            }
+
+            int source = order[i];
+            triangle.z[i] = z[source];
+            triangle.invW[i] = invW[source];
+            for (int k = 0; k < varyingCount; k++) {
+                triangle.varyings[i][k] = corners[source]->varyings[k] * invW[source];
+            }
+
+            minX = std::min(minX, x[i]);
+            minY = std::min(minY, y[i]);
+            maxX = std::max(maxX, x[i]);
+            maxY = std::max(maxY, y[i]);
+        }
+
+        // Pixels whose centers can lie inside the triangle (arithmetic shift rounds down)
+        triangle.minX = (int)std::max<int64_t>(minX >> kSubpixelBits, 0);
+        triangle.minY = (int)std::max<int64_t>(minY >> kSubpixelBits, 0);
+        triangle.maxX = (int)std::min<int64_t>(maxX >> kSubpixelBits, width - 1);
+        triangle.maxY = (int)std::min<int64_t>(maxY >> kSubpixelBits, height - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            continue;
+        }
+
+        data.triangles.push_back(triangle);
+        binTriangle(data, data.triangles.back());
+    }
+}
+
+void Rasterizer::binTriangle(WorkerData& data, const SetupTriangle& triangle) {
+    uint32_t index = (uint32_t)(data.triangles.size() - 1);
+    int tileX0 = triangle.minX / kTileSize;
+    int tileY0 = triangle.minY / kTileSize;
+    int tileX1 = triangle.maxX / kTileSize;
+    int tileY1 = triangle.maxY / kTileSize;
+    bool singleTile = tileX0 == tileX1 && tileY0 == tileY1;
+
+    for (int tileY = tileY0; tileY <= tileY1; tileY++) {
+        for (int tileX = tileX0; tileX <= tileX1; tileX++) {
+            // Skip tiles that lie entirely outside one of the edges, which large
+            // thin triangles would otherwise drag into many bins
+            if (!singleTile) {
+                int64_t px0 = ((int64_t)std::max(tileX * kTileSize, triangle.minX) << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+                int64_t py0 = ((int64_t)std::max(tileY * kTileSize, triangle.minY) << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+                int64_t px1 = ((int64_t)std::min(tileX * kTileSize + kTileSize - 1, triangle.maxX) << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+                int64_t py1 = ((int64_t)std::min(tileY * kTileSize + kTileSize - 1, triangle.maxY) << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+                bool outside = false;
+                for (int i = 0; i < 3 && !outside; i++) {
+                    int64_t px = triangle.a[i] > 0 ? px1 : px0;
+                    int64_t py = triangle.b[i] > 0 ? py1 : py0;
+                    outside = triangle.a[i] * px + triangle.b[i] * py + triangle.c[i] < 0;
+                }
+                if (outside) {
+                    continue;
+                }
+            }
+            data.bins[tileY * tilesX + tileX].push_back(index);
+        }
+    }
+}
+
+void Rasterizer::rasterizeTiles(int worker) {
+    WorkerData& data = workers[worker];
+    int tile;
+    while (tileQueue.pop(worker, tile)) {
+        rasterizeTile(data, tile);
+    }
+}
+
+void Rasterizer::rasterizeTile(WorkerData& data, int tile) {
+    int tileX = tile % tilesX;
+    int tileY = tile / tilesX;
+    int x0 = tileX * kTileSize;
+    int y0 = tileY * kTileSize;
+    int x1 = std::min(x0 + kTileSize, framebuffer.width);
+    int y1 = std::min(y0 + kTileSize, framebuffer.height);
+
+    uint32_t clearValue = packRgba8(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+    for (int y = y0; y < y1; y++) {
+        size_t row = (size_t)y * framebuffer.width;
+        std::fill(framebuffer.color.begin() + row + x0, framebuffer.color.begin() + row + x1, clearValue);
+        std::fill(framebuffer.depth.begin() + row + x0, framebuffer.depth.begin() + row + x1, clearDepth);
+    }
+
+    // Worker slices were set up in submission order, so walking the workers
+    // in order replays the triangles in the order they were drawn
+    for (const auto& source : workers) {
+        for (uint32_t index : source.bins[tile]) {
+            rasterizeTriangle(data, source.triangles[index], tileX, tileY);
+        }
+    }
+}
+
+// Calls shade(pixel, w0, w1, w2) for every pixel of the tile covered by the
+// triangle that passes the depth test, with w0-w2 the screen-space barycentrics
+template <typename Shade>
+uint64_t Rasterizer::walkTriangle(const SetupTriangle& triangle, bool depthTest, int tileX, int tileY, Shade&& shade) {
+    int x0 = std::max(triangle.minX, tileX * kTileSize);
+    int y0 = std::max(triangle.minY, tileY * kTileSize);
+    int x1 = std::min(triangle.maxX, tileX * kTileSize + kTileSize - 1);
+    int y1 = std::min(triangle.maxY, tileY * kTileSize + kTileSize - 1);
+
+    // Edge values at the center of the first pixel and their per-pixel steps
+    int64_t px = ((int64_t)x0 << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+    int64_t py = ((int64_t)y0 << kSubpixelBits) + (1 << (kSubpixelBits - 1));
+    int64_t rowEdge[3], stepX[3], stepY[3];
+    for (int i = 0; i < 3; i++) {
+        rowEdge[i] = triangle.a[i] * px + triangle.b[i] * py + triangle.c[i];
+        stepX[i] = triangle.a[i] << kSubpixelBits;
+        stepY[i] = triangle.b[i] << kSubpixelBits;
+    }
+
+    uint64_t fragments = 0;
+    for (int y = y0; y <= y1; y++) {
+        int64_t e0 = rowEdge[0], e1 = rowEdge[1], e2 = rowEdge[2];
+        uint32_t* colorRow = &framebuffer.color[(size_t)y * framebuffer.width];
+        float* depthRow = &framebuffer.depth[(size_t)y * framebuffer.width];
+
+        for (int x = x0; x <= x1; x++, e0 += stepX[0], e1 += stepX[1], e2 += stepX[2]) {
+            if ((e0 | e1 | e2) < 0) {
+                continue;
+            }
+
+            // Barycentric weights: each edge value is twice the area of the sub-triangle opposite its vertex
+            float w0 = (float)e0 * triangle.invArea;
+            float w1 = (float)e1 * triangle.invArea;
+            float w2 = 1.0f - w0 - w1;
+
+            // Window z is affine in screen space; the varyings are divided by w by the caller
+            if (depthTest) {
+                float z = w0 * triangle.z[0] + w1 * triangle.z[1] + w2 * triangle.z[2];
+                if (!(z < depthRow[x])) {
+                    continue;
+                }
+                depthRow[x] = z;
+            }
+
+            shade(&colorRow[x], w0, w1, w2);
+            fragments++;
+        }
+
+        for (int i = 0; i < 3; i++) {
+            rowEdge[i] += stepY[i];
+        }
+    }
+    return fragments;
+}
+
+void Rasterizer::rasterizeTriangle(WorkerData& data, const SetupTriangle& triangle, int tileX, int tileY) {
+    const DrawState& state = draws[triangle.draw].state;
+
+    // Perspective-correct value of varying k at the given barycentrics
+    auto interpolate = [&triangle](int k, float w0, float w1, float w2, float w) {
+        return (w0 * triangle.varyings[0][k] + w1 * triangle.varyings[1][k] + w2 * triangle.varyings[2][k]) * w;
+    };
+    auto perspectiveW = [&triangle](float w0, float w1, float w2) {
+        return 1.0f / (w0 * triangle.invW[0] + w1 * triangle.invW[1] + w2 * triangle.invW[2]);
+    };
+
+    if (state.shading == ShadeMode::VertexColor) {
+        data.fragments += walkTriangle(triangle, state.depthTest, tileX, tileY,
+            [&](uint32_t* pixel, float w0, float w1, float w2) {
+                float w = perspectiveW(w0, w1, w2);
+                *pixel = packRgba8(interpolate(0, w0, w1, w2, w), interpolate(1, w0, w1, w2, w),
+                                   interpolate(2, w0, w1, w2, w), 1.0f);
+            });
+        return;
+    }
+
+    // Phong: gather fragments into SoA batches and shade eight at a time. The
+    // batch is flushed before the next triangle, so draw order is preserved.
+    PhongBatch batch = {};
+    uint32_t* targets[kPhongBatchSize];
+    uint32_t colors[kPhongBatchSize];
+    int count = 0;
+    auto flush = [&]() {
+        phongKernel(state.phong, batch, colors);
+        for (int i = 0; i < count; i++) {
+            *targets[i] = colors[i];
+        }
+        count = 0;
+    };
+
+    data.fragments += walkTriangle(triangle, state.depthTest, tileX, tileY,
+        [&](uint32_t* pixel, float w0, float w1, float w2) {
+            float w = perspectiveW(w0, w1, w2);
+            batch.positionX[count] = interpolate(0, w0, w1, w2, w);
+            batch.positionY[count] = interpolate(1, w0, w1, w2, w);
+            batch.positionZ[count] = interpolate(2, w0, w1, w2, w);
+            batch.normalX[count] = interpolate(3, w0, w1, w2, w);
+            batch.normalY[count] = interpolate(4, w0, w1, w2, w);
+            batch.normalZ[count] = interpolate(5, w0, w1, w2, w);
+            targets[count++] = pixel;
+            if (count == kPhongBatchSize) {
+                flush();
+            }
+        });
+    if (count > 0) {
+        flush();
+    }
+}
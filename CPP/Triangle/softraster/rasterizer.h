@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "phong_kernel.h"
+#include "tile_queue.h"
+#include "worker_pool.h"
+
+// Attributes carried from the vertex to the fragment stage, interpolated
+// perspective-correctly (the software equivalent of "out"/"in" variables)
+constexpr int kMaxVaryings = 8;
+
+struct RasterVertex {
+    glm::vec4 position;  // clip space, i.e. what gl_Position would hold
+    float varyings[kMaxVaryings];
+};
+
+enum class ShadeMode {
+    // Varyings 0-2 are the RGB output color
+    VertexColor,
+    // phong_triangle.cpp's fragment shader: varyings 0-2 are FragPos, 3-5 Normal
+    Phong
+};
+
+struct DrawState {
+    ShadeMode shading = ShadeMode::VertexColor;
+    int varyingCount = 3;
+    bool depthTest = false;  // GL_LESS when enabled
+    PhongUniforms phong;     // ShadeMode::Phong only
+};
+
+// RGBA8 color (R in the lowest byte, so the bytes match a GL_RGBA /
+// GL_UNSIGNED_BYTE readback) and float depth. Row 0 is the bottom row, as in
+// OpenGL window coordinates.
+struct Framebuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+};
+
+// Multithreaded, tile-binned triangle rasterizer that follows the OpenGL
+// rules closely enough to act as a reference for the GL demos: clipping in
+// clip space, 8-bit subpixel precision, the top-left fill rule, perspective
+// correct interpolation and pixel centers at half-integer coordinates.
+//
+// A frame goes through two parallel passes:
+//   1. setup: workers take contiguous slices of the submitted triangles, clip
+//      them, compute edge equations and append them to per-worker tile bins;
+//   2. raster: workers pull tiles from a work-stealing queue, clear them and
+//      rasterize each bin in submission order.
+// Every pixel belongs to exactly one tile and triangles are applied in
+// submission order, so the image does not depend on the thread count.
+class Rasterizer {
+public:
+    static constexpr int kTileSize = 64;
+    static constexpr int kSubpixelBits = 8;
+
+private:
+    // Triangle after clipping and setup, in fixed-point window coordinates
+    struct SetupTriangle {
+        // Edge equations e(x, y) = a * x + b * y + c (fixed point, top-left bias in c)
+        int64_t a[3], b[3], c[3];
+        int minX, minY, maxX, maxY;  // pixel bounds, inclusive
+        float invArea;
+        float z[3];
+        float invW[3];
+        float varyings[3][kMaxVaryings];  // premultiplied by 1/w
+        int draw;
+    };
+
+    struct DrawCall {
+        DrawState state;
+        size_t firstVertex;
+        size_t vertexCount;
+    };
+
+    struct WorkerData {
+        std::vector<SetupTriangle> triangles;
+        std::vector<std::vector<uint32_t>> bins;  // per tile, indices into triangles
+        uint64_t fragments = 0;
+    };
+
+    Framebuffer framebuffer;
+    WorkerPool pool;
+    TileQueue tileQueue;
+    int tilesX, tilesY;
+    glm::vec4 clearColor;
+    float clearDepth;
+    std::vector<RasterVertex> vertices;
+    std::vector<DrawCall> draws;
+    std::vector<WorkerData> workers;
+    SimdLevel simdLevel;
+    PhongKernel phongKernel;
+
+    void setupTriangles(int worker);
+    void setupTriangle(WorkerData& data, const RasterVertex* v, int draw);
+    void binTriangle(WorkerData& data, const SetupTriangle& triangle);
+    void rasterizeTiles(int worker);
+    void rasterizeTile(WorkerData& data, int tile);
+    void rasterizeTriangle(WorkerData& data, const SetupTriangle& triangle, int tileX, int tileY);
+    template <typename Shade>
+    uint64_t walkTriangle(const SetupTriangle& triangle, bool depthTest, int tileX, int tileY, Shade&& shade);
+
+public:
+    // 0 threads = one per hardware thread
+    Rasterizer(int width, int height, int threadCount = 0);
+
+    int getThreadCount() const { return pool.getWorkerCount(); }
+    SimdLevel getSimdLevel() const { return simdLevel; }
+    const Framebuffer& getFramebuffer() const { return framebuffer; }
+
+    // Starts a frame; the clear happens per tile during the raster pass
+    void beginFrame(const glm::vec4& color, float depth = 1.0f);
+    // Non-indexed triangle list, like glDrawArrays(GL_TRIANGLES, ...)
+    void draw(const DrawState& state, const RasterVertex* first, size_t count);
+    // Runs both passes; returns the number of fragments written
+    uint64_t endFrame();
+};
@@ -0,0 +1,45 @@
+#include "tile_queue.h"
+
+void TileQueue::reset(int tileCount, int workerCount) {
+    if ((int)queues.size() != workerCount) {
+        queues.clear();
+        for (int i = 0; i < workerCount; i++) {
+            queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+        }
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        int begin = (int)((long long)tileCount * i / workerCount);
+        int end = (int)((long long)tileCount * (i + 1) / workerCount);
+        std::lock_guard<std::mutex> lock(queues[i]->mutex);
+        queues[i]->tiles.clear();
+        for (int tile = begin; tile < end; tile++) {
+            queues[i]->tiles.push_back(tile);
+        }
+    }
+}
+
+bool TileQueue::pop(int worker, int& tile) {
+    {
+        WorkerQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tiles.empty()) {
+            tile = own.tiles.front();
+            own.tiles.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the other end, starting with the next worker
+    int workerCount = (int)queues.size();
+    for (int offset = 1; offset < workerCount; offset++) {
+        WorkerQueue& victim = *queues[(worker + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tiles.empty()) {
+            tile = victim.tiles.back();
+            victim.tiles.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Work-stealing queue of tile indices. Every worker starts with a contiguous
+// block of tiles (good cache locality) and takes from the front of its own
+// deque; a worker that runs dry steals from the back of the others, which
+// evens out frames where a few tiles hold most of the triangles.
+class TileQueue {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<int> tiles;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+public:
+    void reset(int tileCount, int workerCount);
+
+    // False once there is no work left anywhere
+    bool pop(int worker, int& tile);
+};
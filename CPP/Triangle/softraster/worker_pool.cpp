@@ -0,0 +1,63 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(int workerCount) : generation(0), pending(0), stopping(false) {
+    if (workerCount <= 0) {
+        workerCount = (int)std::thread::hardware_concurrency();
+    }
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    for (int i = 1; i < workerCount; i++) {
+        threads.emplace_back(&WorkerPool::workerMain, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::workerMain(int index) {
+    unsigned long seenGeneration = 0;
+    for (;;) {
+        std::function<void(int)> current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            current = job;
+        }
+
+        current(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void WorkerPool::run(const std::function<void(int)>& newJob) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = newJob;
+        pending = (int)threads.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [&] { return pending == 0; });
+}
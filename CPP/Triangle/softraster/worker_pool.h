@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that all run the same job and then wait for the
+// next one. The calling thread takes part as worker 0, so a pool of one
+// thread runs everything inline.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    std::function<void(int)> job;
+    unsigned long generation;
+    int pending;
+    bool stopping;
+
+    void workerMain(int index);
+
+public:
+    // 0 = one worker per hardware thread
+    explicit WorkerPool(int workerCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int getWorkerCount() const { return (int)threads.size() + 1; }
+
+    // Runs job(workerIndex) on every worker and returns when all have finished
+    void run(const std::function<void(int)>& job);
+};
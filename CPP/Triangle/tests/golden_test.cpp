@@ -0,0 +1,282 @@
+// Golden-image regression test for the OpenGL demos.
+//
+// Every case runs one demo headless with the replay clock, captures a fixed
+// frame and compares it with tests/golden/<case>.png. All cases run at the
+// same time, one demo process each. An image passes when
+//   - at most --max-outliers (fraction) of its pixels differ from the
+//     reference by more than --threshold in any channel, and
+//   - the structural similarity (SSIM, on luma, 8x8 windows) is at least
+//     --min-ssim,
+// which tolerates rounding differences between drivers but not a moved,
+// missing or recoloured triangle. Failures leave the capture and an amplified
+// difference image in the output directory.
+//
+//   golden_test --bin-dir DIR --golden-dir DIR --out-dir DIR [--update] [case...]
+//
+// --update rewrites the references from the current build instead of comparing.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "stb_image.h"
+#include "core/image_writer.h"
+
+struct TestCase {
+    const char* name;
+    const char* demo;
+    const char* arguments;
+};
+
+// Frame 30 of the replay clock: the triangles are part way through a turn
+static const TestCase testCases[] = {
+    { "triangle_demo", "triangle_demo", "" },
+    { "simple_triangle", "simple_triangle", "" },
+    { "phong_triangle", "phong_triangle", "" },
+    { "phong_triangle_instanced", "phong_triangle", "--instances 64" },
+    { "textured_triangle", "textured_triangle", "" },
+    // One reference per texture path; BC7 is left out, as not every driver samples it
+    { "rose_textured_triangle", "rose_textured_triangle", "--texture rose.ktx2" },
+    { "rose_textured_triangle_png", "rose_textured_triangle", "--texture rose.png" },
+};
+static const int captureFrame = 30;
+
+struct Options {
+    std::string binDir = ".";
+    std::string goldenDir = "golden";
+    std::string outDir = "golden_out";
+    bool update = false;
+    int threshold = 8;
+    double maxOutliers = 0.001;
+    double minSsim = 0.98;
+    std::vector<std::string> cases;
+};
+
+struct Image {
+    int width = 0, height = 0;
+    std::vector<unsigned char> rgb;
+};
+
+struct Result {
+    bool passed = false;
+    std::string message;
+};
+
+static bool loadImage(const std::string& path, Image& image) {
+    int channels = 0;
+    unsigned char* pixels = stbi_load(path.c_str(), &image.width, &image.height, &channels, 3);
+    if (!pixels) {
+        return false;
+    }
+    image.rgb.assign(pixels, pixels + (size_t)image.width * image.height * 3);
+    stbi_image_free(pixels);
+    return true;
+}
+
+// Runs a demo from its own directory (rose_textured_triangle loads its texture from there)
+static int runDemo(const Options& options, const TestCase& testCase, const std::string& capturePattern, const std::string& logPath) {
+    std::string command;
+#ifdef _WIN32
+    command = "cd /d \"" + options.binDir + "\" && " + testCase.demo + ".exe";
+#else
+    command = "cd \"" + options.binDir + "\" && ./" + testCase.demo;
+#endif
+    command += " --headless --clock replay --no-shader-cache --frames " + std::to_string(captureFrame + 1) +
+               " --capture \"" + capturePattern + "\" --capture-every " + std::to_string(captureFrame) +
+               " " + testCase.arguments + " > \"" + logPath + "\" 2>&1";
+    return std::system(command.c_str());
+}
+
+static double luma(const Image& image, size_t pixel) {
+    const unsigned char* p = &image.rgb[pixel * 3];
+    return 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2];
+}
+
+// Mean SSIM over 8x8 windows, stepping 4 pixels
+static double computeSsim(const Image& a, const Image& b) {
+    const double c1 = (0.01 * 255) * (0.01 * 255);
+    const double c2 = (0.03 * 255) * (0.03 * 255);
+    const int window = 8, step = 4;
+
+    std::vector<double> lumaA((size_t)a.width * a.height), lumaB(lumaA.size());
+    for (size_t i = 0; i < lumaA.size(); i++) {
+        lumaA[i] = luma(a, i);
+        lumaB[i] = luma(b, i);
+    }
+
+    double total = 0.0;
+    int windows = 0;
+    for (int y = 0; y + window <= a.height; y += step) {
+        for (int x = 0; x + window <= a.width; x += step) {
+            double sumA = 0, sumB = 0, sumAA = 0, sumBB = 0, sumAB = 0;
+            for (int wy = 0; wy < window; wy++) {
+                for (int wx = 0; wx < window; wx++) {
+                    size_t i = (size_t)(y + wy) * a.width + x + wx;
+                    sumA += lumaA[i];
+                    sumB += lumaB[i];
+                    sumAA += lumaA[i] * lumaA[i];
+                    sumBB += lumaB[i] * lumaB[i];
+                    sumAB += lumaA[i] * lumaB[i];
+                }
+            }
+            const double n = window * window;
+            double meanA = sumA / n, meanB = sumB / n;
+            double varA = sumAA / n - meanA * meanA;
+            double varB = sumBB / n - meanB * meanB;
+            double covariance = sumAB / n - meanA * meanB;
+            total += ((2 * meanA * meanB + c1) * (2 * covariance + c2)) /
+                     ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+            windows++;
+        }
+    }
+    return windows > 0 ? total / windows : 1.0;
+}
+
+static Result runCase(const Options& options, const TestCase& testCase) {
+    Result result;
+    std::string base = options.outDir + "/" + testCase.name;
+    // Frames count from 1, so the run writes a single capture, of frame captureFrame
+    std::string capturePattern = base + "_%d.png";
+    std::string capturePath = base + "_" + std::to_string(captureFrame) + ".png";
+    std::string referencePath = options.goldenDir + "/" + testCase.name + ".png";
+
+    std::remove(capturePath.c_str());
+    if (runDemo(options, testCase, capturePattern, base + ".log") != 0) {
+        result.message = "demo failed, see " + base + ".log";
+        return result;
+    }
+
+    Image actual;
+    if (!loadImage(capturePath, actual)) {
+        result.message = "no capture at " + capturePath + ", see " + base + ".log";
+        return result;
+    }
+
+    if (options.update) {
+        if (!writePng(referencePath, actual.width, actual.height, 3, actual.rgb.data(), (ptrdiff_t)actual.width * 3)) {
+            result.message = "could not write " + referencePath;
+            return result;
+        }
+        result.passed = true;
+        result.message = "reference updated";
+        return result;
+    }
+
+    Image expected;
+    if (!loadImage(referencePath, expected)) {
+        result.message = "no reference at " + referencePath + " (run with --update to create it)";
+        return result;
+    }
+    if (expected.width != actual.width || expected.height != actual.height) {
+        result.message = "size " + std::to_string(actual.width) + "x" + std::to_string(actual.height) +
+                         ", reference is " + std::to_string(expected.width) + "x" + std::to_string(expected.height);
+        return result;
+    }
+
+    // Per-channel outliers, and a difference image scaled so small errors show
+    size_t pixels = (size_t)actual.width * actual.height;
+    size_t outliers = 0;
+    int maxDifference = 0;
+    std::vector<unsigned char> difference(pixels * 3);
+    for (size_t i = 0; i < pixels; i++) {
+        int pixelMax = 0;
+        for (int c = 0; c < 3; c++) {
+            int d = std::abs((int)actual.rgb[i * 3 + c] - (int)expected.rgb[i * 3 + c]);
+            pixelMax = std::max(pixelMax, d);
+            difference[i * 3 + c] = (unsigned char)std::min(255, d * 8);
+        }
+        maxDifference = std::max(maxDifference, pixelMax);
+        if (pixelMax > options.threshold) {
+            outliers++;
+        }
+    }
+    double outlierFraction = (double)outliers / pixels;
+    double ssim = computeSsim(actual, expected);
+
+    result.passed = outlierFraction <= options.maxOutliers && ssim >= options.minSsim;
+    result.message = "ssim " + std::to_string(ssim) + ", " + std::to_string(outliers) + " pixels over threshold, max difference " +
+                     std::to_string(maxDifference);
+    if (!result.passed) {
+        writePng(base + "_diff.png", actual.width, actual.height, 3, difference.data(), (ptrdiff_t)actual.width * 3);
+        result.message += " (see " + base + "_diff.png)";
+    }
+    return result;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--bin-dir DIR] [--golden-dir DIR] [--out-dir DIR] [--update]"
+              << " [--threshold N] [--max-outliers F] [--min-ssim S] [case...]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bin-dir" && hasValue) {
+            options.binDir = argv[++i];
+        } else if (arg == "--golden-dir" && hasValue) {
+            options.goldenDir = argv[++i];
+        } else if (arg == "--out-dir" && hasValue) {
+            options.outDir = argv[++i];
+        } else if (arg == "--update") {
+            options.update = true;
+        } else if (arg == "--threshold" && hasValue) {
+            options.threshold = std::atoi(argv[++i]);
+        } else if (arg == "--max-outliers" && hasValue) {
+            options.maxOutliers = std::atof(argv[++i]);
+        } else if (arg == "--min-ssim" && hasValue) {
+            options.minSsim = std::atof(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.cases.push_back(arg);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<const TestCase*> selected;
+    for (const TestCase& testCase : testCases) {
+        if (options.cases.empty() ||
+            std::find(options.cases.begin(), options.cases.end(), testCase.name) != options.cases.end()) {
+            selected.push_back(&testCase);
+        }
+    }
+    if (selected.empty() || (!options.cases.empty() && selected.size() != options.cases.size())) {
+        std::cerr << "Unknown test case; available:";
+        for (const TestCase& testCase : testCases) {
+            std::cerr << " " << testCase.name;
+        }
+        std::cerr << std::endl;
+        return 2;
+    }
+
+    // The demos run from the bin directory, so captures need absolute paths
+    std::error_code error;
+    std::filesystem::create_directories(options.outDir, error);
+    options.outDir = std::filesystem::absolute(options.outDir).string();
+    options.goldenDir = std::filesystem::absolute(options.goldenDir).string();
+
+    // Demos are separate processes, so cases run fully in parallel
+    std::vector<Result> results(selected.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < selected.size(); i++) {
+        threads.emplace_back([&, i] { results[i] = runCase(options, *selected[i]); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    int failures = 0;
+    for (size_t i = 0; i < selected.size(); i++) {
+        std::cout << (results[i].passed ? "PASS " : "FAIL ") << selected[i]->name << ": " << results[i].message << std::endl;
+        failures += results[i].passed ? 0 : 1;
+    }
+    std::cout << selected.size() - failures << "/" << selected.size() << " golden images match" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// Offline texture baker: converts PNG/JPG/... images into KTX2 files holding
+// RGBA8 or block-compressed data and a full mip chain, ready for
+// loadKtx2Texture() to upload without decoding anything at startup.
+//
+//   texture_baker <input image> <output.ktx2> [--no-mipmaps] [--no-flip]
+//                 [--filter box|kaiser] [--linear] [--format rgba8|bc1|bc3|bc7]
+//
+// Mip levels use the Kaiser filter by default, since baking time does not
+// matter, and treat colour as sRGB; --linear filters the bytes as they are,
+// for data such as normal maps. Compressed formats report the PSNR of the
+// full-size level.
+//
+// Images are flipped to bottom-up row order by default, matching what the
+// demos get from stbi_set_flip_vertically_on_load(true).
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include "core/ktx_texture.h"
+#include "core/mip_builder.h"
+#include "core/block_compress.h"
+#include "core/image_reader.h"
+#include "stb_image.h"
+
+int main(int argc, char** argv) {
+    std::string inputPath;
+    std::string outputPath;
+    bool mipmaps = true;
+    bool flip = true;
+    MipOptions mipOptions;
+    mipOptions.filter = MipFilter::Kaiser;
+    bool compress = false;
+    BlockFormat blockFormat = BlockFormat::BC7;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--no-mipmaps") {
+            mipmaps = false;
+        } else if (arg == "--no-flip") {
+            flip = false;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            std::string filter = argv[++i];
+            if (filter != "box" && filter != "kaiser") {
+                inputPath.clear();
+                break;
+            }
+            mipOptions.filter = filter == "box" ? MipFilter::Box : MipFilter::Kaiser;
+        } else if (arg == "--linear") {
+            mipOptions.srgb = false;
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            compress = format != "rgba8";
+            if (format == "bc1") {
+                blockFormat = BlockFormat::BC1;
+            } else if (format == "bc3") {
+                blockFormat = BlockFormat::BC3;
+            } else if (format == "bc7") {
+                blockFormat = BlockFormat::BC7;
+            } else if (compress) {
+                inputPath.clear();
+                break;
+            }
+        } else if (inputPath.empty() && arg[0] != '-') {
+            inputPath = arg;
+        } else if (outputPath.empty() && arg[0] != '-') {
+            outputPath = arg;
+        } else {
+            inputPath.clear();
+            break;
+        }
+    }
+    if (inputPath.empty() || outputPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <input image> <output.ktx2> [--no-mipmaps] [--no-flip]"
+                  << " [--filter box|kaiser] [--linear] [--format rgba8|bc1|bc3|bc7]" << std::endl;
+        return -1;
+    }
+
+    int width, height, channels;
+    std::string error;
+    unsigned char* pixels = loadImageFile(inputPath, width, height, channels, 4, flip, error);
+    if (!pixels) {
+        std::cerr << "Failed to load " << inputPath << ": " << error << std::endl;
+        return -1;
+    }
+
+    std::vector<std::vector<unsigned char>> levels;
+    levels.emplace_back(pixels, pixels + (size_t)width * height * 4);
+    if (mipmaps) {
+        std::vector<std::vector<unsigned char>> mips;
+        buildMipChain(pixels, width, height, 4, mipOptions, mips);
+        for (auto& mip : mips) {
+            levels.push_back(std::move(mip));
+        }
+    }
+    stbi_image_free(pixels);
+
+    uint32_t vkFormat = kVkFormatR8G8B8A8Unorm;
+    double psnr = 0.0;
+    if (compress) {
+        static const uint32_t blockVkFormats[] = { kVkFormatBc1RgbUnorm, kVkFormatBc3Unorm, kVkFormatBc7Unorm };
+        vkFormat = blockVkFormats[(int)blockFormat];
+
+        std::vector<unsigned char> original = levels[0];
+        int levelWidth = width, levelHeight = height;
+        for (auto& level : levels) {
+            std::vector<unsigned char> blocks;
+            compressImage(level.data(), levelWidth, levelHeight, blockFormat, BlockCompressOptions(), blocks);
+            level.swap(blocks);
+            levelWidth = std::max(levelWidth / 2, 1);
+            levelHeight = std::max(levelHeight / 2, 1);
+        }
+
+        // BC1 drops alpha, so only colour counts towards the error
+        std::vector<unsigned char> decoded;
+        decompressImage(levels[0].data(), width, height, blockFormat, decoded);
+        int channelsCompared = blockFormat == BlockFormat::BC1 ? 3 : 4;
+        double squaredError = 0.0;
+        for (size_t i = 0; i < decoded.size(); i++) {
+            if ((int)(i % 4) < channelsCompared) {
+                double d = (double)decoded[i] - original[i];
+                squaredError += d * d;
+            }
+        }
+        double meanSquaredError = squaredError / ((double)width * height * channelsCompared);
+        psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+    }
+
+    if (!writeKtx2(outputPath, vkFormat, width, height, levels)) {
+        return -1;
+    }
+    std::cout << "Baked " << inputPath << " (" << width << "x" << height << ", " << channels << " channels) into "
+              << outputPath << " with " << levels.size() << " levels";
+    if (mipmaps) {
+        std::cout << " (" << mipFilterName(mipOptions.filter) << " filter, " << (mipOptions.srgb ? "sRGB" : "linear") << ")";
+    }
+    if (compress) {
+        std::cout << ", " << blockFormatName(blockFormat) << " at " << psnr << " dB PSNR";
+    }
+    std::cout << std::endl;
+    return 0;
+}
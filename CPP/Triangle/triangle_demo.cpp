@@ -1,8 +1,9 @@
 #include <iostream>
 #include <vector>
-#include <string>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "core/demo_app.h"
+#include "core/gl_objects.h"
 
 // Shader sources
 const char* vertexShaderSource = R"(
@@ -30,11 +31,10 @@ void main()
 }
 )";
 
-class TriangleRenderer {
+class TriangleRenderer : public DemoApp {
 private:
-    GLFWwindow* window;
-    GLuint shaderProgram;
-    GLuint VAO, VBO;
+    ShaderProgram shader;
+    Mesh mesh;
     
     // Vertex data (position + color)
     std::vector<float> vertices = {
@@ -43,187 +43,55 @@ private:
          0.5f, -0.5f, 0.0f,     0.0f, 1.0f, 0.0f,  // Green
          0.0f,  0.5f, 0.0f,     0.0f, 0.0f, 1.0f   // Blue
     };
-
-public:
-    TriangleRenderer() : window(nullptr), shaderProgram(0), VAO(0), VBO(0) {}
     
-    bool init() {
-        // Initialize GLFW
-        if (!glfwInit()) {
-            std::cerr << "Failed to initialize GLFW" << std::endl;
-            return false;
-        }
-        
-        // Configure GLFW
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-        
-        // Create window
-        window = glfwCreateWindow(800, 600, "Triangle Demo - Computer Graphics (C++)", nullptr, nullptr);
-        if (!window) {
-            std::cerr << "Failed to create GLFW window" << std::endl;
-            glfwTerminate();
-            return false;
-        }
-        
-        glfwMakeContextCurrent(window);
-        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-        
-        // Load OpenGL function pointers
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-            std::cerr << "Failed to initialize GLAD" << std::endl;
-            return false;
-        }
-        
-        // Create shaders
-        if (!createShaders()) {
-            return false;
-        }
-        
-        // Setup buffers
-        setupBuffers();
-        
-        return true;
+    static DemoConfig makeConfig() {
+        DemoConfig config;
+        config.name = "triangle_demo";
+        config.title = "Triangle Demo - Computer Graphics (C++)";
+        config.forwardCompat = true;
+        return config;
     }
+
+public:
+    TriangleRenderer(const RunOptions& options) : DemoApp(makeConfig(), options) {}
     
-    bool createShaders() {
-        // Vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-        
-        // Check compilation
-        if (!checkShaderCompilation(vertexShader, "Vertex")) {
-            return false;
-        }
-        
-        // Fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
-        
-        // Check compilation
-        if (!checkShaderCompilation(fragmentShader, "Fragment")) {
-            return false;
-        }
-        
-        // Create shader program
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        // Check linking
-        if (!checkProgramLinking()) {
+    bool setup() override {
+        if (!createProgram(shader, vertexShaderSource, fragmentShaderSource)) {
             return false;
         }
         
-        // Clean up shaders
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        
-        return true;
+        // Position (location = 0) and color (location = 1)
+        return mesh.create(vertices.data(), 3, { 3, 3 });
     }
     
-    bool checkShaderCompilation(GLuint shader, const std::string& type) {
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-            std::cerr << "ERROR::SHADER::" << type << "::COMPILATION_FAILED\n" << infoLog << std::endl;
-            return false;
+    void render() override {
+        {
+            GpuZone zone(gpuProfiler, "clear");
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
         }
-        return true;
-    }
-    
-    bool checkProgramLinking() {
-        GLint success;
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            GLchar infoLog[512];
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-            return false;
-        }
-        return true;
-    }
-    
-    void setupBuffers() {
-        // Create VAO
-        glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
-        
-        // Create VBO
-        glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-        
-        // Position attribute (location = 0)
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        
-        // Color attribute (location = 1)
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        
-        // Unbind
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
-    
-    void render() {
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
         
-        glUseProgram(shaderProgram);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-    
-    void run() {
-        std::cout << "Triangle Demo is running!" << std::endl;
-        std::cout << "Press ESC or close window to exit" << std::endl;
-        
-        while (!glfwWindowShouldClose(window)) {
-            render();
-            
-            // Handle input
-            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-                glfwSetWindowShouldClose(window, true);
-            }
-        }
-    }
-    
-    void cleanup() {
-        if (VAO) glDeleteVertexArrays(1, &VAO);
-        if (VBO) glDeleteBuffers(1, &VBO);
-        if (shaderProgram) glDeleteProgram(shaderProgram);
-        if (window) glfwTerminate();
-    }
-    
-    static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
-        glViewport(0, 0, width, height);
-    }
-    
-    ~TriangleRenderer() {
-        cleanup();
+        shader.use();
+        GpuZone zone(gpuProfiler, "draw");
+        mesh.draw();
     }
 };
 
-int main() {
-    TriangleRenderer renderer;
+int main(int argc, char** argv) {
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) {
+        return -1;
+    }
     
+    TriangleRenderer renderer(options);
     if (!renderer.init()) {
         std::cerr << "Failed to initialize renderer" << std::endl;
         return -1;
     }
     
+    std::cout << "Triangle Demo is running!" << std::endl;
+    std::cout << "Press ESC or close window to exit" << std::endl;
+    
     renderer.run();
     
     return 0;